@@ -1,21 +1,42 @@
+#variants GRADIENT
+
 #shader vertex
 #version 330 core
 
 layout(location = 0) in vec4 position;
 
-void main()
+// per object, written once per frame for every object (UniformRingBuffer)
+layout(std140) uniform Object
 {
-   gl_Position = position;
+   mat4 u_Transform;
+   vec4 u_Color;
 };
 
+out vec2 v_Position;
+
+void main()
+{
+   gl_Position = u_Transform * position;
+   v_Position = position.xy;
+}
+
 #shader fragment
 #version 330 core
 
 layout(location = 0) out vec4 color;
 
-uniform vec4 u_Color;
+layout(std140) uniform Object
+{
+   mat4 u_Transform;
+   vec4 u_Color;
+};
+
+in vec2 v_Position;
 
 void main()
 {
    color = u_Color;
-};
\ No newline at end of file
+   // GRADIENT: darker towards the bottom of the quad, which spans -0.5 to 0.5
+   if (GRADIENT)
+      color.rgb *= 1.0 + v_Position.y;
+}
@@ -0,0 +1,47 @@
+#shader vertex
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : enable
+
+// one thumbnail per draw of a MeshBatch, a multi draw per pool page. the base
+// instance is the draw's index across all of them and picks its block out of the
+// storage buffer (gl_DrawIDARB starts over with every multi draw)
+layout(location = 0) in vec2 position;
+
+struct Thumbnail
+{
+   vec4 placement; // xy offset, zw scale
+   vec4 color;
+};
+
+layout(std430, binding = 1) readonly buffer Thumbnails
+{
+   Thumbnail thumbnails[];
+};
+
+#ifdef GL_ARB_shader_draw_parameters
+#define DRAW_ID gl_BaseInstanceARB
+#else
+uniform int u_DrawID; // set per draw when there is no multi draw
+#define DRAW_ID u_DrawID
+#endif
+
+flat out vec4 v_Color;
+
+void main()
+{
+   Thumbnail thumbnail = thumbnails[DRAW_ID];
+   gl_Position = vec4(position * thumbnail.placement.zw + thumbnail.placement.xy, 0.0, 1.0);
+   v_Color = thumbnail.color;
+}
+
+#shader fragment
+#version 430 core
+
+flat in vec4 v_Color;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+   color = v_Color;
+}
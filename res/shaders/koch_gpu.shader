@@ -0,0 +1,50 @@
+#shader vertex
+#version 330 core
+
+// no vertex buffer at all, every vertex walks the recursion from its
+// gl_VertexID, so the bump angle and subdivision ratio are just uniforms.
+// with u_Ratio = 1/3 and u_Angle = pi/3 it matches generateKochSnowflake
+uniform int u_Depth;
+uniform float u_Angle;
+uniform float u_Ratio;
+uniform vec2 u_Corners[3];
+
+void main()
+{
+   int span = 1 << (2 * u_Depth); // segments per triangle edge
+   int segment = gl_VertexID / 2;
+   int edge = segment / span;
+   int point = segment % span + gl_VertexID % 2; // 0..span along the edge
+
+   vec2 a = u_Corners[edge];
+   vec2 b = u_Corners[(edge + 1) % 3];
+   mat2 rotation = mat2(cos(u_Angle), sin(u_Angle), -sin(u_Angle), cos(u_Angle));
+
+   while (point != 0 && point != span)
+   {
+      vec2 d = b - a;
+      vec2 p2 = a + u_Ratio * d;
+      vec2 p3 = b - u_Ratio * d;
+      vec2 bump = p2 + u_Ratio * (rotation * d);
+
+      span /= 4;
+      int child = point / span;
+      point -= child * span;
+
+      if (child == 0)      { b = p2; }
+      else if (child == 1) { a = p2; b = bump; }
+      else if (child == 2) { a = bump; b = p3; }
+      else                 { a = p3; }
+   }
+   gl_Position = vec4(point == 0 ? a : b, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+   color = vec4(0.0, 0.8, 1.0, 1.0); // Light blue color for snowflake
+}
@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+void main()
+{
+   gl_Position = position;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+// drawn while the real program is still compiling
+void main()
+{
+   color = vec4(0.3, 0.3, 0.3, 1.0);
+}
@@ -0,0 +1,25 @@
+#shader vertex
+#version 330 core
+
+// every vertex also carries where it sat one level up, so going from depth to
+// depth + 1 is just a mix on the gpu and nothing gets regenerated per frame
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 parentPosition;
+
+uniform float u_Time;
+
+void main()
+{
+   float t = 0.5 - 0.5 * cos(u_Time); // eased ping-pong, rests on both levels
+   gl_Position = vec4(mix(parentPosition, position, t), 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+   color = vec4(1.0, 1.0, 1.0, 1.0); // white
+}
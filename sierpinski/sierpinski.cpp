@@ -3,57 +3,53 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
-
-const char* vertexShaderSource = R"(
-#version 330 core
-layout(location = 0) in vec2 position;
-void main()
+#include <cstring>
+#include <algorithm>
+
+#include "GLDebug.h"
+#include "Profiler.h"
+#include "VertexBuffer.h"
+#include "StreamingVertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Fractals.h"
+#include "FractalVertices.h"
+#include "GLSinks.h"
+#include "BakedFractals.h"
+
+int main(int argc, char** argv)
 {
-    gl_Position = vec4(position, 0.0, 1.0);
-})";
+    // Initial points of the equilateral triangle (shared with the baked levels)
+    const float* p0 = kFractalCorners[0];
+    const float* p1 = kFractalCorners[1];
+    const float* p2 = kFractalCorners[2];
 
-const char* fragmentShaderSource = R"(
-#version 330 core
-out vec4 color;
-void main()
-{
-    color = vec4(1.0, 1.0, 1.0, 1.0); //white
-})";
+    // Depth of recursion ( 11 or 12 gives kinda sax result)
+    // animates between depth and depth + 1, past ~8 the step is smaller than a pixel.
+    // up / down change it while running
+    int depth = 5;
+    const int maxDepth = 8;
 
-void generateSierpinski(std::vector<float>& vertices, float p0[2], float p1[2], float p2[2], int depth)
-{
-    if (depth == 0)
+    // --export file: the triangles at the starting depth as raw floats, no window
+    if (argc > 2 && strcmp(argv[1], "--export") == 0)
     {
-        // Base Case
-        vertices.push_back(p0[0]); // x of first point
-        vertices.push_back(p0[1]); // y of first point
-        vertices.push_back(p1[0]); // x of second point
-        vertices.push_back(p1[1]); // y of second point
-        vertices.push_back(p2[0]); // x of third point
-        vertices.push_back(p2[1]); // y of third point
+        FileSink sink(argv[2]);
+        generateSierpinski(sink, p0, p1, p2, depth);
+        if (!sink.Close())
+        {
+            std::cout << "Could not write " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << sink.GetSize() << " floats to " << argv[2] << std::endl;
+        return 0;
     }
-    else
-    {
-        // mid - point
-        float m0[2] = { (p0[0] + p1[0])/2, (p0[1]+p1[1])/2 };
-        float m1[2] = { (p1[0] + p2[0])/2, (p1[1]+p2[1])/2 }; 
-        float m2[2] = { (p0[0] + p2[0])/2, (p0[1]+p2[1])/2 }; 
-
-        // Recurse on the 3 new edges
-        generateSierpinski(vertices, m2, m1, p2, depth - 1); // depth is the recursive variable
-        generateSierpinski(vertices, p0, m0, m2, depth - 1);
-        generateSierpinski(vertices, m0, p1, m1, depth - 1);
-    }
-}
-
 
-int main(void)
-{
     GLFWwindow* window;
 
     if (!glfwInit())
         return -1;
 
+    GLDebugWindowHints();
     window = glfwCreateWindow(640, 480, "sierpinski", NULL, NULL);
     if (!window)
     {
@@ -69,97 +65,76 @@ int main(void)
         std::cout << "Error initializing GLEW" << std::endl;
         return -1;
     }
-
-    std::vector<float> vertices;
-
-    // Initial points of the equilateral triangle
-    float p0[2] = {-0.5f, -0.5f};
-    float p1[2] = {0.5f, -0.5f};
-    float p2[2] = {0.0f, 0.5f};
-
-    // Depth of recursion ( 11 or 12 gives kinda sax result)
-    int depth = 10;
-
-    generateSierpinski(vertices, p0, p1, p2, depth);
-    // generateSierpinski(vertices, p1, p2, p0, depth);
-    // generateSierpinski(vertices, p2, p0, p1, depth);
-
-    // Create and compile the vertex shader
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    // Check for compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    // Create and compile the fragment shader
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    // Check for compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    // Link the shaders into a program
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    // Check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-
-    // Clean up shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Create and bind a Vertex Array Object (VAO)
-    unsigned int vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-
-    // Create a Vertex Buffer Object (VBO)
-    unsigned int vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // Set up the vertex attribute pointers
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Main render loop
-    while (!glfwWindowShouldClose(window))
-    {
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(shaderProgram);
-        glBindVertexArray(vao);
-        // glDrawArrays(GL_LINES, 0, vertices.size() / 2);  // Draw the pattern as lines
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 2);  // Draw the pattern as lines
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    GLDebugInit();
+    Profiler::Init(); // MATH_ENGINE_TRACE=trace.json
+
+    { // scoped so the buffers are deleted while the context is still alive
+        // compiled into the binary, MATH_ENGINE_SHADERS_FROM_DISK=1 reads res/shaders instead
+        Shader shader("./res/shaders/sierpinski_morph.shader");
+
+        // allocated and mapped once, every depth change is written into the next free
+        // region while the GPU may still be drawing the previous one
+        const std::size_t stride = sizeof(MorphVertex);
+        StreamingVertexBuffer stream(3 * sierpinskiMorphFloatCount(maxDepth) * sizeof(float));
+
+        VertexArray va;
+        va.AddBuffer<MorphVertex>(stream);
+
+        StreamingVertexBuffer::Region region = { nullptr, 0, 0 };
+        unsigned int firstVertex = 0;
+        std::size_t floatCount = 0;
+        int generatedDepth = -1;
+        bool upWasPressed = false, downWasPressed = false;
+
+        // Main render loop
+        while (!glfwWindowShouldClose(window))
+        {
+            Profiler::Frame();
+            bool up = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+            bool down = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+            if (up && !upWasPressed)
+                depth = std::min(depth + 1, maxDepth);
+            if (down && !downWasPressed)
+                depth = std::max(depth - 1, 0);
+            upWasPressed = up;
+            downWasPressed = down;
+
+            if (depth != generatedDepth)
+            {
+                // last frame's draw was the last to read the old region, the ring
+                // must not wrap onto it before that is done
+                stream.Fence(region);
+                PROFILE_ZONE("generateSierpinskiMorph");
+                // small depths are baked into the binary, the rest is generated in place
+                BakedGeometry baked = getBakedSierpinskiMorph(depth);
+                floatCount = sierpinskiMorphFloatCount(depth);
+                StreamingBufferSink sink(stream, floatCount, stride); // committed at the end of this block
+                if (baked.data)
+                    sink.Write(baked.data, baked.count);
+                else
+                    generateSierpinskiMorph(sink, p0, p1, p2, depth);
+                region = sink.GetRegion();
+                firstVertex = sink.GetFirstVertex();
+                generatedDepth = depth;
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            shader.Bind();
+            shader.SetUniform1f("u_Time", (float)glfwGetTime());
+            va.Bind();
+            // glDrawArrays(GL_LINES, 0, floatCount / 4);  // Draw the pattern as lines
+            glDrawArrays(GL_TRIANGLES, firstVertex, floatCount / 4);  // filled triangles, 4 floats per morph vertex
+
+            {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(window);
+            }
+            glfwPollEvents();
+        }
     }
 
-    glDeleteProgram(shaderProgram);
+    Profiler::Shutdown();
     glfwTerminate();
     return 0;
 }
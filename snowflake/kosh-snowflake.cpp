@@ -3,70 +3,54 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
-
-// Vertex and Fragment shader source code as strings
-const char* vertexShaderSource = R"(
-#version 330 core
-layout(location = 0) in vec2 position;
-void main()
+#include <cstring>
+#include <algorithm>
+
+#include "GLDebug.h"
+#include "Profiler.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Fractals.h"
+#include "FractalVertices.h"
+#include "GLSinks.h"
+#include "BakedFractals.h"
+
+int main(int argc, char** argv)
 {
-    gl_Position = vec4(position, 0.0, 1.0);
-})";
+    bool gpuMode = argc > 1 && strcmp(argv[1], "--gpu") == 0;
 
-const char* fragmentShaderSource = R"(
-#version 330 core
-out vec4 color;
-void main()
-{
-    color = vec4(0.0, 0.8, 1.0, 1.0); // Light blue color for snowflake
-})";
+    // Initial points of the equilateral triangle (shared with the baked levels)
+    const float* p0 = kFractalCorners[0];
+    const float* p1 = kFractalCorners[1];
+    const float* p2 = kFractalCorners[2];
 
-// Recursive function to generate Koch snowflake vertices
-void generateKochSnowflake(std::vector<float>& vertices, float p0[2], float p1[2], int depth)
-{
-    if (depth == 0)
-    {
-        // Base case: add the line from p0 to p1
-        vertices.push_back(p0[0]);
-        vertices.push_back(p0[1]);
-        vertices.push_back(p1[0]);
-        vertices.push_back(p1[1]);
-    }
-    else
+    // Depth of recursion (try 3 or 4 for a clear snowflake)
+    // animates between depth and depth + 1
+    int depth = 3;
+
+    // --export file: the three edges at the starting depth as raw floats, no window
+    if (argc > 2 && strcmp(argv[1], "--export") == 0)
     {
-        // Subdivide the line segment p0 -> p1 into 3 parts
-        float dx = p1[0] - p0[0];
-        float dy = p1[1] - p0[1];
-
-        // Calculate the 3 intermediate points
-        float p2[2] = { p0[0] + dx / 3.0f, p0[1] + dy / 3.0f };
-        float p3[2] = { p0[0] + 2.0f * dx / 3.0f, p0[1] + 2.0f * dy / 3.0f };
-
-        // Calculate the bump point (perpendicular triangle)
-        float angle = M_PI / 3.0f; // 60 degrees
-        float length = sqrt(dx * dx + dy * dy) / 3.0f;
-        float bumpX = (p2[0] + p3[0]) / 2.0f + length * cos(angle + atan2(dy, dx));
-        float bumpY = (p2[1] + p3[1]) / 2.0f + length * sin(angle + atan2(dy, dx));
-
-        // Create bump array
-        float bump[2] = { bumpX, bumpY };
-
-        // Recurse on the 3 new edges
-        generateKochSnowflake(vertices, p0, p2, depth - 1);
-        generateKochSnowflake(vertices, p2, bump, depth - 1);
-        generateKochSnowflake(vertices, bump, p3, depth - 1);
-        generateKochSnowflake(vertices, p3, p1, depth - 1);
+        FileSink sink(argv[2]);
+        generateKochSnowflake(sink, p0, p1, depth);
+        generateKochSnowflake(sink, p1, p2, depth);
+        generateKochSnowflake(sink, p2, p0, depth);
+        if (!sink.Close())
+        {
+            std::cout << "Could not write " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << sink.GetSize() << " floats to " << argv[2] << std::endl;
+        return 0;
     }
-}
-
 
-int main(void)
-{
     GLFWwindow* window;
 
     if (!glfwInit())
         return -1;
 
+    GLDebugWindowHints();
     window = glfwCreateWindow(640, 480, "Koch Snowflake", NULL, NULL);
     if (!window)
     {
@@ -82,98 +66,94 @@ int main(void)
         std::cout << "Error initializing GLEW" << std::endl;
         return -1;
     }
+    GLDebugInit();
+    Profiler::Init(); // MATH_ENGINE_TRACE=trace.json
 
-    // Vertices to hold Koch snowflake points
-    std::vector<float> vertices;
-
-    // Initial points of the equilateral triangle
-    float p0[2] = {-0.5f, -0.5f};
-    float p1[2] = {0.5f, -0.5f};
-    float p2[2] = {0.0f, 0.5f};
-
-    // Depth of recursion (try 3 or 4 for a clear snowflake)
-    int depth = 4;
-
-    // Generate Koch snowflake vertices
-    generateKochSnowflake(vertices, p0, p1, depth);
-    generateKochSnowflake(vertices, p1, p2, depth);
-    generateKochSnowflake(vertices, p2, p0, depth);
-
-    // Create and compile the vertex shader
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    // Check for compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    // Create and compile the fragment shader
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    // small depths are baked into the binary, otherwise the Koch snowflake
+    // vertices are generated straight into the mapped vertex buffer further down
+    BakedGeometry baked = getBakedKochSnowflakeMorph(depth);
+    std::size_t floatCount = 3 * kochSnowflakeMorphFloatCount(depth);
 
-    // Check for compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    if (gpuMode)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    // Link the shaders into a program
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    // Check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        float corners[6] = { p0[0], p0[1], p1[0], p1[1], p2[0], p2[1] };
+        float angle = M_PI / 3.0f; // left / right
+        float ratio = 1.0f / 3.0f; // up / down
+
+        { // scoped so the program and the vertex array die before the context
+            // compiled into the binary, MATH_ENGINE_SHADERS_FROM_DISK=1 reads res/shaders instead
+            Shader shader("./res/shaders/koch_gpu.shader");
+            shader.Bind();
+            shader.SetUniform1i("u_Depth", depth + 1);
+            shader.SetUniform2fv("u_Corners", 3, corners);
+
+            VertexArray va; // core profile still wants a vertex array bound, it stays empty
+            while (!glfwWindowShouldClose(window))
+            {
+                Profiler::Frame();
+                if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)  angle -= 0.01f;
+                if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) angle += 0.01f;
+                if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)  ratio = std::max(0.0f, ratio - 0.002f);
+                if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)    ratio = std::min(0.5f, ratio + 0.002f);
+
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                shader.Bind();
+                shader.SetUniform1f("u_Angle", angle);
+                shader.SetUniform1f("u_Ratio", ratio);
+                va.Bind();
+                glDrawArrays(GL_LINES, 0, 3 * 2 * (1 << (2 * (depth + 1)))); // 3 edges, 4^(depth + 1) segments each
+
+                {
+                    PROFILE_ZONE("swap");
+                    glfwSwapBuffers(window);
+                }
+                glfwPollEvents();
+            }
+        }
+
+        Profiler::Shutdown();
+        glfwTerminate();
+        return 0;
     }
 
-    // Clean up shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Create and bind a Vertex Array Object (VAO)
-    unsigned int vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-
-    // Create a Vertex Buffer Object (VBO)
-    unsigned int vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // Set up the vertex attribute pointers
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Main render loop
-    while (!glfwWindowShouldClose(window))
-    {
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(shaderProgram);
-        glBindVertexArray(vao);
-        glDrawArrays(GL_LINES, 0, vertices.size() / 2);  // Draw the Koch snowflake as lines
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    { // scoped so the buffers are deleted while the context is still alive
+        // compiled into the binary, MATH_ENGINE_SHADERS_FROM_DISK=1 reads res/shaders instead
+        Shader shader("./res/shaders/koch_morph.shader");
+
+        VertexArray va;
+        VertexBuffer vb(baked.data, floatCount * sizeof(float));
+        if (!baked.data)
+        {
+            PROFILE_ZONE("generateKochSnowflakeMorph");
+            MappedBufferSink sink(vb, floatCount); // unmapped at the end of this block
+            generateKochSnowflakeMorph(sink, p0, p1, depth);
+            generateKochSnowflakeMorph(sink, p1, p2, depth);
+            generateKochSnowflakeMorph(sink, p2, p0, depth);
+        }
+
+        va.AddBuffer<MorphVertex>(vb);
+
+        // Main render loop
+        while (!glfwWindowShouldClose(window))
+        {
+            Profiler::Frame();
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            shader.Bind();
+            shader.SetUniform1f("u_Time", (float)glfwGetTime());
+            va.Bind();
+            glDrawArrays(GL_LINES, 0, floatCount / 4);  // Draw the Koch snowflake as lines
+
+            {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(window);
+            }
+            glfwPollEvents();
+        }
     }
 
-    glDeleteProgram(shaderProgram);
+    Profiler::Shutdown();
     glfwTerminate();
     return 0;
 }
@@ -3,109 +3,76 @@
 #include <iostream>
 #include <cmath>
 #include <csignal>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 #include "Renderer.h"
 
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
-
-struct ShaderProgramSource
+#include "Shader.h"
+#include "ShaderCompileQueue.h"
+#include "ShaderWatcher.h"
+#include "ShaderLibrary.h"
+#include "ShaderParser.h"
+#include "UniformBuffer.h"
+#include "GLStateCache.h"
+#include "BufferPool.h"
+#include "MeshBatch.h"
+#include "MeshOptimizer.h"
+#include "GPUProfiler.h"
+#include "Profiler.h"
+#include "Fractals.h"
+#include "FractalVertices.h"
+
+// the Object block of basic.shader
+struct ObjectUniforms
 {
-    std::string VertexSource;
-    std::string FragmentSource;
+    std140::mat4 transform;
+    std140::vec4 color;
 };
+STD140_OFFSET(ObjectUniforms, transform, 0);
+STD140_OFFSET(ObjectUniforms, color, 64);
 
-static ShaderProgramSource ParseShader(const std::string &filepath)
+// per draw data of gallery.shader
+struct Thumbnail
 {
-    std::ifstream stream(filepath);
-
-    enum class ShaderType
-    {
-        NONE = -1,
-        VERTEX = 0,
-        FRAGMENT = 1
-    };
-
-    std::string line;
-    std::stringstream ss[2];
-    ShaderType type = ShaderType::NONE;
-    while (getline(stream, line))
-    {
-        if (line.find("#shader") != std::string::npos)
-        {
-            if (line.find("vertex") != std::string::npos)
-            {
-                type = ShaderType::VERTEX;
-            }
-            else if (line.find("fragment") != std::string::npos)
-            {
-                type = ShaderType::FRAGMENT;
-            }
-        }
-        else
-        {
-            ss[(int)type] << line << '\n';
-        }
-    }
-    return {ss[0].str(), ss[1].str()};
-}
+    std140::vec4 placement; // xy offset, zw scale
+    std140::vec4 color;
+};
+STD140_OFFSET(Thumbnail, placement, 0);
+STD140_OFFSET(Thumbnail, color, 16);
 
-static unsigned int CompileShader(unsigned int type, const std::string &source)
+int main(int argc, char **argv)
 {
-    unsigned int id = glCreateShader(type);
-    const char *src = &source[0]; // source.c_str();
-    glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id);
-
-    // Error Handling
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
+    // development mode: edits to res/shaders are picked up without a restart
+    bool hotReload = std::getenv("MATH_ENGINE_HOT_RELOAD") != nullptr;
+    // a wall of fractal thumbnails, all in one multi draw
+    bool gallery = false;
+    // GPU time per pass, printed at exit
+    bool gpuProfile = std::getenv("MATH_ENGINE_GPU_PROFILE") != nullptr;
+    for (int i = 1; i < argc; i++)
     {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char *message = (char *)alloca(length * sizeof(char)); // allocate on stack here instead of heap
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile "
-                  << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
-                  << " shader!" << std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
-    } // alloca - allocate on the stack dynamically
-
-    return id;
-}
-
-static unsigned int CreateShader(const std::string &vertexShader, const std::string &fragmentShader)
-{
-    unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glValidateProgram(program);
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
-    return program;
-}
+        if (strcmp(argv[i], "--hot-reload") == 0)
+            hotReload = true;
+        else if (strcmp(argv[i], "--gallery") == 0)
+            gallery = true;
+        else if (strcmp(argv[i], "--gpu-profile") == 0)
+            gpuProfile = true;
+    }
 
-int main(void)
-{
     GLFWwindow *window;
 
     /* Initialize the library */
     if (!glfwInit())
         return -1;
 
+    GLDebugWindowHints();
+
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
     if (!window)
@@ -124,81 +91,222 @@ int main(void)
         std::cout << "Error initializing GLEW" << std::endl;
         return -1;
     }
+    GLDebugInit(); // GL errors through KHR_debug, MATH_ENGINE_GL_DEBUG=sync to trap on the call
+    Profiler::Init(); // MATH_ENGINE_TRACE=trace.json records a CPU timeline
+
+    { // scoped so every GL object is deleted while the context is still alive
+        PositionVertex positions[] = {
+            { -0.5f, -0.5f }, // 0
+            { 0.5f, 0.5f },   // 1
+            { 0.5f, -0.5f },  // 2
+            { -0.5f, 0.5f }   // 3
+        };
+
+        unsigned int indices[] = {// tho int are 4 bytes, can use char or short
+                                  2, 1, 0,
+                                  0, 3, 1};
+
+        // unsigned int vao; // vertex attribute object
+        // glGenVertexArrays(1, &vao);
+        // glBindVertexArray(vao);
+
+        VertexArray va;
+        VertexBuffer vb(positions, sizeof(positions));
+        va.AddBuffer<PositionVertex>(vb);
 
-    float positions[] = {
-        -0.5f, -0.5f, // 0
-        0.5f, 0.5f,   // 1
-        0.5f, -0.5f,  // 2
-        -0.5f, 0.5f   // 3
-    };
+        IndexBuffer ib(indices, 6);
+        va.SetIndexBuffer(ib);
+
+        // every program is submitted up front and compiles in the background, the
+        // placeholder is tiny and built right away so the first frames have something to draw
+        ShaderCompileQueue compileQueue;
+        std::unique_ptr<ShaderWatcher> watcher;
+        if (hotReload)
+        {
+            // the watcher reads res/shaders from disk, the rest has to as well
+            ShaderParser::SetDiskOverride(true);
+            watcher = std::make_unique<ShaderWatcher>("./res/shaders");
+        }
 
-    unsigned int indices[] = {// tho int are 4 bytes, can use char or short
-                              2, 1, 0,
-                              0, 3, 1};
+        // one program per (file, #variants permutation), compiled through the queue
+        ShaderLibrary shaders(&compileQueue, watcher.get());
+        // embedded at build time, so this works from any working directory. both GRADIENT
+        // permutations are compiled up front, G switches between them
+        shaders.Precompile("./res/shaders/basic.shader");
+        Shader& shader = shaders.Get("./res/shaders/basic.shader");
+        Shader& gradientShader = shaders.Get("./res/shaders/basic.shader", { "GRADIENT" });
+        Shader placeholder("./res/shaders/placeholder.shader");
+        bool gradient = false, gWasPressed = false;
+
+        // per object uniforms for the whole frame go up in one call and are bound by range
+        const unsigned int objectBinding = 0;
+        UniformRingBuffer uniforms(64 * 1024);
+        shader.SetUniformBlockBinding("Object", objectBinding);
+        gradientShader.SetUniformBlockBinding("Object", objectBinding);
+
+        Renderer renderer(&uniforms, objectBinding);
+
+        // gallery: sierpinski depths 1 to 5 are sub-allocated from one pool buffer,
+        // up adds the next depth, down drops the shallowest one and packs the pool,
+        // 200 thumbnails of them go out as a single glMultiDrawElementsIndirect
+        BufferPool meshPool;
+        const unsigned int thumbnailBinding = 1; // storage buffer binding in gallery.shader
+        const unsigned int thumbnailCount = 200;
+        std::unique_ptr<MeshBatch> thumbnails;
+        std::vector<MeshBatch::MeshID> thumbnailMeshes;
+        Shader* galleryShader = nullptr;
+        auto addGalleryMesh = [&](int depth)
+        {
+            const float corners[3][2] = { {-0.5f, -0.5f}, {0.5f, -0.5f}, {0.0f, 0.5f} };
+            std::vector<float> vertices;
+            generateSierpinski(vertices, corners[0], corners[1], corners[2], depth);
+            // shared corners welded, triangles and vertices in cache friendly order
+            std::vector<unsigned int> meshIndices;
+            MeshOptimizeReport report = OptimizeMesh(vertices, 2, meshIndices);
+            std::cout << "Sierpinski depth " << depth << ": " << report.inputVertices << " -> "
+                      << report.weldedVertices << " vertices, ACMR " << report.before.acmr << " -> "
+                      << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+            thumbnailMeshes.push_back(thumbnails->AddMesh(vertices.data(), vertices.size() / 2,
+                                                          meshIndices.data(), meshIndices.size()));
+        };
+        if (gallery && !GLEW_VERSION_4_3)
+            std::cout << "--gallery needs OpenGL 4.3 for storage buffers, skipping it" << std::endl;
+        else if (gallery)
+        {
+            PROFILE_ZONE("gallery setup");
+            thumbnails = std::make_unique<MeshBatch>(meshPool, PositionVertex());
+            for (int depth = 1; depth <= 5; depth++)
+                addGalleryMesh(depth);
+            galleryShader = &shaders.Get("./res/shaders/gallery.shader");
+        }
+        int galleryDepth = 5; // the deepest mesh in the gallery
+        const int maxGalleryDepth = 8;
+        bool upWasPressed = false, downWasPressed = false;
 
-    // unsigned int vao; // vertex attribute object
-    // glGenVertexArrays(1, &vao);
-    // glBindVertexArray(vao);
+        // ------
+        va.Unbind();
+        placeholder.Unbind();
+        vb.Unbind();
+        ib.Unbind();
+
+        GPUProfiler profiler(gpuProfile);
+
+        float r = 0.0f;
+        float increment = 0.05f;
+        unsigned long long frames = 0;
+        /* Loop until the user closes the window */
+        while (!glfwWindowShouldClose(window)) // render loop (like game loop)
+        {
+            Profiler::Frame();
+            profiler.BeginFrame();
 
-    VertexArray va;
-    VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+            /* Render here */
+            {
+                GPUProfiler::Scope pass(profiler, "clear");
+                renderer.Clear();
+            }
 
-    VertexBufferLayout layout;
-    layout.Push(GL_FLOAT, 2);
-    va.AddBuffer(vb, layout);
+            {
+                PROFILE_ZONE("shader updates");
+                compileQueue.Poll(); // doesn't wait on drivers with parallel shader compile
+                if (watcher)
+                    watcher->Update(); // between frames, so a program never changes mid-frame
+            }
 
-    IndexBuffer ib(indices, 6);
+            // ------
+            uniforms.BeginFrame();
+            renderer.BeginFrame();
 
-    ShaderProgramSource source = ParseShader("./res/shaders/basic.shader"); //  filepath should be relative to the executable!!!
-    unsigned int shader = CreateShader(source.VertexSource, source.FragmentSource);
-    // glUseProgram(shader); // bound shader
+            bool g = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+            if (g && !gWasPressed)
+                gradient = !gradient;
+            gWasPressed = g;
+            Shader& quadShader = gradient ? gradientShader : shader;
 
-    int location = glGetUniformLocation(shader, "u_Color");
-    ASSERT(location != -1);
-    glUniform4f(location, 0.8f, 0.3f, 0.8f, 1.0f);
+            UniformAllocation object = uniforms.Push(ObjectUniforms{ std140::identity, { r, 0.3f, 0.8f, 1.0f } });
+            renderer.Submit(va, ib, quadShader.IsReady() ? quadShader : placeholder, object);
 
-    // ------
-    glBindVertexArray(0);
-    glUseProgram(0); // bound shader
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            // one upload for every block of the frame, then the whole queue in one pass
+            {
+                GPUProfiler::Scope pass(profiler, "uniform upload");
+                uniforms.Upload();
+            }
+            {
+                GPUProfiler::Scope pass(profiler, "scene");
+                renderer.Flush();
+            }
 
-    float r = 0.0f;
-    float increment = 0.05f;
-    /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window)) // render loop (like game loop)
-    {
-        /* Render here */
-        glClear(GL_COLOR_BUFFER_BIT);
+            if (thumbnails)
+            {
+                // before anything is recorded: Defragment moves the meshes
+                bool up = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+                bool down = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+                if (up && !upWasPressed && galleryDepth < maxGalleryDepth)
+                    addGalleryMesh(++galleryDepth);
+                if (down && !downWasPressed && thumbnailMeshes.size() > 1)
+                {
+                    // the shallowest mesh is the oldest, at the front of its page
+                    thumbnails->RemoveMesh(thumbnailMeshes.front());
+                    thumbnailMeshes.erase(thumbnailMeshes.begin());
+                    meshPool.Defragment();
+                }
+                upWasPressed = up;
+                downWasPressed = down;
+            }
 
-        // ------
-        glUseProgram(shader); // bound shader
-        glUniform4f(location, r, 0.3f, 0.8f, 1.0f);
+            if (thumbnails)
+            {
+                GPUProfiler::Scope pass(profiler, "gallery"); // mesh batch upload included
+                // 20 x 10 cells over the whole window
+                PROFILE_ZONE("gallery");
+                thumbnails->BeginFrame();
+                for (unsigned int i = 0; i < thumbnailCount; i++)
+                {
+                    float x = -0.95f + (i % 20) * 0.1f;
+                    float y = 0.9f - (i / 20) * 0.2f;
+                    float shade = (float)i / thumbnailCount;
+                    thumbnails->Draw(thumbnailMeshes[i % thumbnailMeshes.size()],
+                                     Thumbnail{ { x, y, 0.09f, 0.18f }, { r, shade, 1.0f - shade, 1.0f } });
+                }
+                renderer.DrawBatch(*thumbnails, *galleryShader, thumbnailBinding);
+            }
+            // -------
 
-        // glBindVertexArray(vao);
-        va.Bind();
-        ib.Bind();
-        // -------
+            if (r > 1.0f)
+                increment = -0.05f;
+            else if (r < 0.0f)
+                increment = 0.05f;
 
-        // error handling using the defined macros and functions
-        GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr)); // null as already bound
+            r += increment;
 
-        if (r > 1.0f)
-            increment = -0.05f;
-        else if (r < 0.0f)
-            increment = 0.05f;
+            profiler.EndFrame(); // before the swap, which may block on vsync
 
-        r += increment;
+            {
+                PROFILE_ZONE("swap"); // waits for vsync
+                /* Swap front and back buffers */
+                glfwSwapBuffers(window);
+            }
 
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+            /* Poll for and process events */
+            glfwPollEvents();
+            frames++;
+        }
 
-        /* Poll for and process events */
-        glfwPollEvents();
+        // redundant binds never reach the driver (GLStateCache)
+        const GLStateCache::Counters& binds = GLStateCache::Get().GetCounters();
+        if (frames > 0)
+            std::cout << "Binds per frame: " << binds.GetIssued() / (double)frames << " issued, "
+                      << binds.GetElided() / (double)frames << " elided" << std::endl;
+        if (thumbnails)
+        {
+            BufferPool::Stats pool = meshPool.GetStats();
+            std::cout << "Mesh pool: " << pool.allocations << " meshes in " << pool.pages << " buffer(s), "
+                      << pool.usedBytes << " bytes used" << std::endl;
+        }
+        profiler.Report(std::cout);
     }
 
-    glDeleteProgram(shader);
-
+    Profiler::Shutdown();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "Fractals.h"
+
+// Small depths of the demo fractals evaluated at compile time into read-only data,
+// so they can go straight into a VertexBuffer at startup without running a generator.
+// Deeper levels still go through the runtime generators.
+
+// the triangle both demos start from
+constexpr float kFractalCorners[3][2] = { {-0.5f, -0.5f}, {0.5f, -0.5f}, {0.0f, 0.5f} };
+
+constexpr int kMaxBakedDepth = 6; // deepest geometry that is baked, morphs bake depth -> depth + 1 up to it
+
+// constexpr sink over a std::array of exactly the generated size
+template <std::size_t N>
+struct BakingSink
+{
+    std::array<float, N> data{};
+    std::size_t size = 0;
+
+    constexpr void Write(const float* values, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count && size < N; i++)
+            data[size++] = values[i];
+    }
+};
+
+template <int Depth>
+constexpr auto bakeSierpinski()
+{
+    BakingSink<sierpinskiFloatCount(Depth)> sink;
+    generateSierpinski(sink, kFractalCorners[0], kFractalCorners[1], kFractalCorners[2], Depth);
+    return sink.data;
+}
+
+template <int Depth>
+constexpr auto bakeSierpinskiMorph()
+{
+    BakingSink<sierpinskiMorphFloatCount(Depth)> sink;
+    generateSierpinskiMorph(sink, kFractalCorners[0], kFractalCorners[1], kFractalCorners[2], Depth);
+    return sink.data;
+}
+
+// all three edges of the snowflake
+template <int Depth>
+constexpr auto bakeKochSnowflake()
+{
+    BakingSink<3 * kochSnowflakeFloatCount(Depth)> sink;
+    generateKochSnowflake(sink, kFractalCorners[0], kFractalCorners[1], Depth);
+    generateKochSnowflake(sink, kFractalCorners[1], kFractalCorners[2], Depth);
+    generateKochSnowflake(sink, kFractalCorners[2], kFractalCorners[0], Depth);
+    return sink.data;
+}
+
+template <int Depth>
+constexpr auto bakeKochSnowflakeMorph()
+{
+    BakingSink<3 * kochSnowflakeMorphFloatCount(Depth)> sink;
+    generateKochSnowflakeMorph(sink, kFractalCorners[0], kFractalCorners[1], Depth);
+    generateKochSnowflakeMorph(sink, kFractalCorners[1], kFractalCorners[2], Depth);
+    generateKochSnowflakeMorph(sink, kFractalCorners[2], kFractalCorners[0], Depth);
+    return sink.data;
+}
+
+template <int Depth> inline constexpr auto kBakedSierpinski = bakeSierpinski<Depth>();
+template <int Depth> inline constexpr auto kBakedSierpinskiMorph = bakeSierpinskiMorph<Depth>();
+template <int Depth> inline constexpr auto kBakedKochSnowflake = bakeKochSnowflake<Depth>();
+template <int Depth> inline constexpr auto kBakedKochSnowflakeMorph = bakeKochSnowflakeMorph<Depth>();
+
+struct BakedGeometry
+{
+    const float* data;
+    std::size_t count; // in floats, 0 when the depth isn't baked
+};
+
+namespace BakedTables
+{
+    template <std::size_t... Depths>
+    constexpr std::array<BakedGeometry, sizeof...(Depths)> Sierpinski(std::index_sequence<Depths...>)
+    {
+        return {{ { kBakedSierpinski<Depths>.data(), kBakedSierpinski<Depths>.size() }... }};
+    }
+
+    template <std::size_t... Depths>
+    constexpr std::array<BakedGeometry, sizeof...(Depths)> SierpinskiMorph(std::index_sequence<Depths...>)
+    {
+        return {{ { kBakedSierpinskiMorph<Depths>.data(), kBakedSierpinskiMorph<Depths>.size() }... }};
+    }
+
+    template <std::size_t... Depths>
+    constexpr std::array<BakedGeometry, sizeof...(Depths)> KochSnowflake(std::index_sequence<Depths...>)
+    {
+        return {{ { kBakedKochSnowflake<Depths>.data(), kBakedKochSnowflake<Depths>.size() }... }};
+    }
+
+    template <std::size_t... Depths>
+    constexpr std::array<BakedGeometry, sizeof...(Depths)> KochSnowflakeMorph(std::index_sequence<Depths...>)
+    {
+        return {{ { kBakedKochSnowflakeMorph<Depths>.data(), kBakedKochSnowflakeMorph<Depths>.size() }... }};
+    }
+
+    inline constexpr auto kSierpinski = Sierpinski(std::make_index_sequence<kMaxBakedDepth + 1>());
+    inline constexpr auto kSierpinskiMorph = SierpinskiMorph(std::make_index_sequence<kMaxBakedDepth>());
+    inline constexpr auto kKochSnowflake = KochSnowflake(std::make_index_sequence<kMaxBakedDepth + 1>());
+    inline constexpr auto kKochSnowflakeMorph = KochSnowflakeMorph(std::make_index_sequence<kMaxBakedDepth>());
+}
+
+// lookups by runtime depth, {nullptr, 0} when the caller has to generate instead
+constexpr BakedGeometry getBakedSierpinski(int depth)
+{
+    return depth >= 0 && depth <= kMaxBakedDepth ? BakedTables::kSierpinski[depth] : BakedGeometry{nullptr, 0};
+}
+
+constexpr BakedGeometry getBakedSierpinskiMorph(int depth)
+{
+    return depth >= 0 && depth < kMaxBakedDepth ? BakedTables::kSierpinskiMorph[depth] : BakedGeometry{nullptr, 0};
+}
+
+constexpr BakedGeometry getBakedKochSnowflake(int depth)
+{
+    return depth >= 0 && depth <= kMaxBakedDepth ? BakedTables::kKochSnowflake[depth] : BakedGeometry{nullptr, 0};
+}
+
+constexpr BakedGeometry getBakedKochSnowflakeMorph(int depth)
+{
+    return depth >= 0 && depth < kMaxBakedDepth ? BakedTables::kKochSnowflakeMorph[depth] : BakedGeometry{nullptr, 0};
+}
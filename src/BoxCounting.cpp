@@ -0,0 +1,315 @@
+#include "BoxCounting.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // one bit per box, row major. the finest level is written by every worker at
+    // once so its words are atomic, coarser levels are built afterwards
+    class OccupancyGrid
+    {
+    private:
+        unsigned int m_Size; // boxes per side
+        std::size_t m_WordCount;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> m_Words;
+
+    public:
+        explicit OccupancyGrid(int level)
+            : m_Size(1u << level), m_WordCount((std::size_t(m_Size) * m_Size + 63) / 64),
+              m_Words(new std::atomic<std::uint64_t>[m_WordCount])
+        {
+            for (std::size_t i = 0; i < m_WordCount; i++)
+                m_Words[i].store(0, std::memory_order_relaxed);
+        }
+
+        inline unsigned int GetSize() const { return m_Size; }
+        inline std::size_t GetWordCount() const { return m_WordCount; }
+
+        void Mark(int x, int y)
+        {
+            std::size_t index = std::size_t(y) * m_Size + x;
+            std::uint64_t bit = std::uint64_t(1) << (index & 63);
+            std::atomic<std::uint64_t>& word = m_Words[index >> 6];
+            // most marks hit boxes that are already set, skip the read-modify-write then
+            if (!(word.load(std::memory_order_relaxed) & bit))
+                word.fetch_or(bit, std::memory_order_relaxed);
+        }
+
+        bool Test(unsigned int x, unsigned int y) const
+        {
+            std::size_t index = std::size_t(y) * m_Size + x;
+            return (m_Words[index >> 6].load(std::memory_order_relaxed) >> (index & 63)) & 1;
+        }
+
+        void Set(unsigned int x, unsigned int y)
+        {
+            std::size_t index = std::size_t(y) * m_Size + x;
+            m_Words[index >> 6].fetch_or(std::uint64_t(1) << (index & 63), std::memory_order_relaxed);
+        }
+
+        std::size_t CountRange(std::size_t begin, std::size_t end) const
+        {
+            std::size_t count = 0;
+            for (std::size_t i = begin; i < end; i++)
+                count += std::bitset<64>(m_Words[i].load(std::memory_order_relaxed)).count();
+            return count;
+        }
+    };
+
+    // maps generator space into grid space of the finest level
+    struct GridTransform
+    {
+        float minX, minY, scale;
+        int last; // size - 1
+
+        inline float X(float x) const { return (x - minX) * scale; }
+        inline float Y(float y) const { return (y - minY) * scale; }
+        inline int Cell(float v) const { return std::min(std::max(int(v), 0), last); }
+    };
+
+    // every box the segment passes through (Amanatides & Woo traversal)
+    void MarkLine(OccupancyGrid& grid, const GridTransform& t, float x0, float y0, float x1, float y1)
+    {
+        x0 = t.X(x0); y0 = t.Y(y0);
+        x1 = t.X(x1); y1 = t.Y(y1);
+
+        int cx = t.Cell(x0), cy = t.Cell(y0);
+        int ex = t.Cell(x1), ey = t.Cell(y1);
+        grid.Mark(cx, cy);
+
+        const float inf = std::numeric_limits<float>::infinity();
+        float dx = x1 - x0, dy = y1 - y0;
+        int stepX = dx > 0.0f ? 1 : -1;
+        int stepY = dy > 0.0f ? 1 : -1;
+        float tDeltaX = dx != 0.0f ? std::abs(1.0f / dx) : inf;
+        float tDeltaY = dy != 0.0f ? std::abs(1.0f / dy) : inf;
+        float tMaxX = dx > 0.0f ? (cx + 1 - x0) / dx : dx < 0.0f ? (x0 - cx) / -dx : inf;
+        float tMaxY = dy > 0.0f ? (cy + 1 - y0) / dy : dy < 0.0f ? (y0 - cy) / -dy : inf;
+
+        int steps = std::abs(ex - cx) + std::abs(ey - cy);
+        for (int i = 0; i < steps; i++)
+        {
+            if (tMaxX < tMaxY)
+            {
+                cx += stepX;
+                tMaxX += tDeltaX;
+            }
+            else
+            {
+                cy += stepY;
+                tMaxY += tDeltaY;
+            }
+            grid.Mark(std::min(std::max(cx, 0), t.last), std::min(std::max(cy, 0), t.last));
+        }
+    }
+
+    // a box touches a filled triangle if an edge crosses it or it lies inside,
+    // so the edges plus every box whose centre is inside covers it exactly
+    void MarkTriangle(OccupancyGrid& grid, const GridTransform& t, const float* a, const float* b, const float* c)
+    {
+        MarkLine(grid, t, a[0], a[1], b[0], b[1]);
+        MarkLine(grid, t, b[0], b[1], c[0], c[1]);
+        MarkLine(grid, t, c[0], c[1], a[0], a[1]);
+
+        float ax = t.X(a[0]), ay = t.Y(a[1]);
+        float bx = t.X(b[0]), by = t.Y(b[1]);
+        float cx = t.X(c[0]), cy = t.Y(c[1]);
+        float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        if (area == 0.0f)
+            return;
+
+        int x0 = t.Cell(std::min({ax, bx, cx})), x1 = t.Cell(std::max({ax, bx, cx}));
+        int y0 = t.Cell(std::min({ay, by, cy})), y1 = t.Cell(std::max({ay, by, cy}));
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                float px = x + 0.5f, py = y + 0.5f;
+                float w0 = (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+                float w1 = (cx - bx) * (py - by) - (cy - by) * (px - bx);
+                float w2 = (ax - cx) * (py - cy) - (ay - cy) * (px - cx);
+                if (area > 0.0f ? (w0 >= 0 && w1 >= 0 && w2 >= 0) : (w0 <= 0 && w1 <= 0 && w2 <= 0))
+                    grid.Mark(x, y);
+            }
+        }
+    }
+
+    // splits [0, count) into one contiguous chunk per worker and waits for all of them.
+    // traced on the calling thread only, the workers are short lived and would each
+    // leave a thread buffer in the profiler
+    template <typename Fn>
+    void ParallelFor(unsigned int threads, std::size_t count, Fn&& fn)
+    {
+        PROFILE_ZONE("box counting ParallelFor");
+        threads = std::max(1u, (unsigned int)std::min<std::size_t>(threads, count));
+        if (threads == 1)
+        {
+            fn(0u, std::size_t(0), count);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        std::size_t chunk = (count + threads - 1) / threads;
+        for (unsigned int i = 0; i < threads; i++)
+        {
+            std::size_t begin = std::min(count, i * chunk);
+            std::size_t end = std::min(count, begin + chunk);
+            workers.emplace_back([&fn, i, begin, end]() { fn(i, begin, end); });
+        }
+        for (auto& worker : workers)
+            worker.join();
+    }
+}
+
+BoxCountingResult EstimateBoxDimension(const float* vertices, std::size_t vertexCount,
+                                       FractalPrimitive primitive, const BoxCountingParams& params)
+{
+    PROFILE_ZONE("EstimateBoxDimension");
+    BoxCountingResult result;
+    unsigned int stride = params.stride ? params.stride : 2;
+    int maxLevel = std::min(std::max(params.maxLevel, 0), 15);
+    int minLevel = std::min(std::max(params.minLevel, 0), maxLevel);
+    unsigned int threads = params.threads ? params.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    unsigned int perPrimitive = primitive == FractalPrimitive::Triangles ? 3 : primitive == FractalPrimitive::Lines ? 2 : 1;
+    std::size_t primitiveCount = vertexCount / perPrimitive;
+    if (!vertices || primitiveCount == 0)
+        return result;
+
+    // bounds, one partial box per worker. ParallelFor may run fewer workers than
+    // threads, the slots it leaves alone have to read as empty
+    std::vector<float> bounds(std::size_t(threads) * 4);
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        bounds[i * 4 + 0] = bounds[i * 4 + 1] = std::numeric_limits<float>::max();
+        bounds[i * 4 + 2] = bounds[i * 4 + 3] = std::numeric_limits<float>::lowest();
+    }
+    ParallelFor(threads, vertexCount, [&](unsigned int worker, std::size_t begin, std::size_t end)
+    {
+        float minX = std::numeric_limits<float>::max(), minY = minX;
+        float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const float* v = vertices + i * stride;
+            minX = std::min(minX, v[0]); maxX = std::max(maxX, v[0]);
+            minY = std::min(minY, v[1]); maxY = std::max(maxY, v[1]);
+        }
+        float* b = &bounds[worker * 4];
+        b[0] = minX; b[1] = minY; b[2] = maxX; b[3] = maxY;
+    });
+
+    float minX = std::numeric_limits<float>::max(), minY = minX;
+    float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        const float* b = &bounds[i * 4];
+        if (b[0] > b[2]) // worker had nothing to do
+            continue;
+        minX = std::min(minX, b[0]); minY = std::min(minY, b[1]);
+        maxX = std::max(maxX, b[2]); maxY = std::max(maxY, b[3]);
+    }
+
+    // square domain so boxes stay square, widened a hair so the max edge maps inside
+    float side = std::max(maxX - minX, maxY - minY);
+    side = side > 0.0f ? side * 1.0001f : 1.0f;
+
+    OccupancyGrid finest(maxLevel);
+    GridTransform transform{minX, minY, float(finest.GetSize()) / side, int(finest.GetSize()) - 1};
+
+    ParallelFor(threads, primitiveCount, [&](unsigned int, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const float* v = vertices + i * perPrimitive * stride;
+            switch (primitive)
+            {
+            case FractalPrimitive::Points:
+                finest.Mark(transform.Cell(transform.X(v[0])), transform.Cell(transform.Y(v[1])));
+                break;
+            case FractalPrimitive::Lines:
+                MarkLine(finest, transform, v[0], v[1], v[stride], v[stride + 1]);
+                break;
+            case FractalPrimitive::Triangles:
+                MarkTriangle(finest, transform, v, v + stride, v + 2 * stride);
+                break;
+            }
+        }
+    });
+
+    // walk the pyramid down to minLevel, a coarse box is occupied if any of its 4 children is
+    std::vector<std::size_t> partial(threads);
+    auto count = [&](const OccupancyGrid& grid)
+    {
+        ParallelFor(threads, grid.GetWordCount(), [&](unsigned int worker, std::size_t begin, std::size_t end)
+        {
+            partial[worker] = grid.CountRange(begin, end);
+        });
+        std::size_t total = 0;
+        for (std::size_t n : partial)
+            total += n;
+        std::fill(partial.begin(), partial.end(), 0);
+        return total;
+    };
+
+    result.levels.push_back(maxLevel);
+    result.occupied.push_back(count(finest));
+
+    std::unique_ptr<OccupancyGrid> fine;
+    const OccupancyGrid* source = &finest;
+    for (int level = maxLevel - 1; level >= minLevel; level--)
+    {
+        auto coarse = std::make_unique<OccupancyGrid>(level);
+        ParallelFor(threads, coarse->GetSize(), [&](unsigned int, std::size_t begin, std::size_t end)
+        {
+            for (unsigned int y = (unsigned int)begin; y < end; y++)
+                for (unsigned int x = 0; x < coarse->GetSize(); x++)
+                    if (source->Test(2 * x, 2 * y) || source->Test(2 * x + 1, 2 * y) ||
+                        source->Test(2 * x, 2 * y + 1) || source->Test(2 * x + 1, 2 * y + 1))
+                        coarse->Set(x, y);
+        });
+
+        result.levels.push_back(level);
+        result.occupied.push_back(count(*coarse));
+        fine = std::move(coarse);
+        source = fine.get();
+    }
+
+    std::reverse(result.levels.begin(), result.levels.end());
+    std::reverse(result.occupied.begin(), result.occupied.end());
+
+    // least squares on (level, log2 N), eps halves per level so the slope is the dimension
+    std::size_t n = result.levels.size();
+    if (n < 2)
+        return result;
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        double x = result.levels[i];
+        double y = std::log2(double(std::max<std::size_t>(result.occupied[i], 1)));
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    double slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double intercept = (sy - slope * sx) / n;
+
+    double residual = 0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        double y = std::log2(double(std::max<std::size_t>(result.occupied[i], 1)));
+        double e = y - (intercept + slope * result.levels[i]);
+        residual += e * e;
+    }
+
+    result.dimension = float(slope);
+    result.fitError = float(std::sqrt(residual / n));
+    return result;
+}
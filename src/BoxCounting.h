@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// how consecutive vertices of the generator output are grouped
+enum class FractalPrimitive
+{
+    Points,   // any IFS / chaos-game point cloud
+    Lines,    // pairs, e.g. generateKochSnowflake
+    Triangles // triples, e.g. generateSierpinski
+};
+
+struct BoxCountingParams
+{
+    int minLevel = 2;         // coarsest grid has 2^minLevel boxes per side
+    int maxLevel = 9;         // finest grid that gets rasterized, the rest are reduced from it
+    unsigned int stride = 2;  // floats per vertex, xy are always the first two
+    unsigned int threads = 0; // 0 -> std::thread::hardware_concurrency()
+};
+
+struct BoxCountingResult
+{
+    std::vector<int> levels;           // log2 of boxes per side
+    std::vector<std::size_t> occupied; // N(eps) for every level
+    float dimension = 0.0f;            // slope of log N against log 1/eps
+    float fitError = 0.0f;             // rms residual of the fit, in log2 units
+};
+
+// Rasterizes the vertex data (read in place, never copied) into a shared occupancy
+// bitset at maxLevel, builds the coarser levels by 2x2 reduction and fits the
+// box-counting dimension over [minLevel, maxLevel].
+BoxCountingResult EstimateBoxDimension(const float* vertices, std::size_t vertexCount,
+                                       FractalPrimitive primitive, const BoxCountingParams& params = {});
+
+inline BoxCountingResult EstimateBoxDimension(const std::vector<float>& vertices, FractalPrimitive primitive,
+                                              const BoxCountingParams& params = {})
+{
+    unsigned int stride = params.stride ? params.stride : 2;
+    return EstimateBoxDimension(vertices.data(), vertices.size() / stride, primitive, params);
+}
@@ -0,0 +1,232 @@
+#include "BufferPool.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <utility>
+
+static std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+BufferPool::BufferPool(std::size_t pageSize)
+    : m_PageSize(pageSize)
+{
+}
+
+unsigned int BufferPool::AddPage(std::size_t size)
+{
+    Page page;
+    page.size = size;
+    page.free[0] = size;
+    page.buffer = BufferHandle::Create();
+    // the copy targets aren't part of any vertex array or the cached state
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer.Get());
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW));
+    m_Pages.push_back(std::move(page));
+    return (unsigned int)m_Pages.size() - 1;
+}
+
+bool BufferPool::Carve(Page& page, std::size_t size, std::size_t alignment, std::size_t& offset)
+{
+    for (auto it = page.free.begin(); it != page.free.end(); ++it)
+    {
+        std::size_t begin = it->first;
+        std::size_t end = begin + it->second;
+        offset = AlignUp(begin, alignment);
+        if (offset + size > end)
+            continue;
+
+        // whatever the allocation doesn't cover on either side stays free
+        page.free.erase(it);
+        if (offset > begin)
+            page.free[begin] = offset - begin;
+        if (offset + size < end)
+            page.free[offset + size] = end - offset - size;
+        return true;
+    }
+    return false;
+}
+
+BufferPool::Handle BufferPool::Allocate(std::size_t size, std::size_t alignment)
+{
+    if (size == 0 || alignment == 0)
+        return kInvalid;
+
+    Allocation allocation = { 0, 0, size, alignment };
+    bool found = false;
+    for (unsigned int i = 0; i < m_Pages.size() && !found; i++)
+    {
+        found = Carve(m_Pages[i], size, alignment, allocation.offset);
+        allocation.page = i;
+    }
+    if (!found)
+    {
+        allocation.page = AddPage(std::max(m_PageSize, size));
+        Carve(m_Pages[allocation.page], size, alignment, allocation.offset);
+    }
+
+    if (!m_FreeHandles.empty())
+    {
+        Handle handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+        m_Allocations[handle] = allocation;
+        return handle;
+    }
+    m_Allocations.push_back(allocation);
+    return (Handle)m_Allocations.size() - 1;
+}
+
+BufferPool::Handle BufferPool::Allocate(const void* data, std::size_t size, std::size_t alignment)
+{
+    Handle handle = Allocate(size, alignment);
+    if (handle != kInvalid)
+        Upload(handle, data, size);
+    return handle;
+}
+
+void BufferPool::Upload(Handle handle, const void* data, std::size_t size, std::size_t offset)
+{
+    PROFILE_ZONE("BufferPool::Upload");
+    const Allocation& allocation = m_Allocations[handle];
+    if (offset + size > allocation.size)
+    {
+        std::cout << "BufferPool: upload of " << size << " bytes at " << offset
+                  << " is past the end of a " << allocation.size << " byte allocation" << std::endl;
+        return;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_Pages[allocation.page].buffer.Get());
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset + offset, size, data));
+}
+
+void BufferPool::Free(Handle handle)
+{
+    if (handle >= m_Allocations.size() || m_Allocations[handle].size == 0)
+        return;
+
+    Allocation& allocation = m_Allocations[handle];
+    std::map<std::size_t, std::size_t>& free = m_Pages[allocation.page].free;
+    std::size_t begin = allocation.offset;
+    std::size_t end = begin + allocation.size;
+
+    // coalesce with the free ranges right after and right before
+    auto next = free.lower_bound(begin);
+    if (next != free.end() && next->first == end)
+    {
+        end += next->second;
+        next = free.erase(next);
+    }
+    if (next != free.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == begin)
+        {
+            begin = previous->first;
+            free.erase(previous);
+        }
+    }
+    free[begin] = end - begin;
+
+    allocation.size = 0;
+    m_FreeHandles.push_back(handle);
+}
+
+void BufferPool::Defragment()
+{
+    PROFILE_ZONE("BufferPool::Defragment");
+    // handles of the live allocations, by page and offset
+    std::vector<Handle> live;
+    for (Handle handle = 0; handle < m_Allocations.size(); handle++)
+    {
+        if (m_Allocations[handle].size != 0)
+            live.push_back(handle);
+    }
+    std::sort(live.begin(), live.end(), [this](Handle a, Handle b)
+    {
+        const Allocation& x = m_Allocations[a];
+        const Allocation& y = m_Allocations[b];
+        return x.page != y.page ? x.page < y.page : x.offset < y.offset;
+    });
+
+    // a buffer can't be copied onto an overlapping range of itself, so the packed
+    // page is assembled in scratch and copied back in one go
+    BufferHandle scratch;
+    std::size_t scratchSize = 0;
+    auto first = live.begin();
+    for (unsigned int i = 0; i < m_Pages.size(); i++)
+    {
+        Page& page = m_Pages[i];
+        auto last = std::find_if(first, live.end(), [this, i](Handle handle) { return m_Allocations[handle].page != i; });
+
+        // already packed if nothing would move
+        bool packed = true;
+        std::size_t end = 0;
+        for (auto it = first; it != last && packed; ++it)
+        {
+            const Allocation& allocation = m_Allocations[*it];
+            packed = allocation.offset == AlignUp(end, allocation.alignment);
+            end = allocation.offset + allocation.size;
+        }
+        if (packed)
+        {
+            first = last;
+            continue;
+        }
+
+        if (scratchSize < page.size)
+        {
+            if (!scratch)
+                scratch = BufferHandle::Create();
+            glBindBuffer(GL_COPY_WRITE_BUFFER, scratch.Get());
+            GLCall(glBufferData(GL_COPY_WRITE_BUFFER, page.size, nullptr, GL_STREAM_COPY));
+            scratchSize = page.size;
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, page.buffer.Get());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, scratch.Get());
+        page.free.clear();
+        end = 0;
+        for (auto it = first; it != last; ++it)
+        {
+            Allocation& allocation = m_Allocations[*it];
+            std::size_t offset = AlignUp(end, allocation.alignment);
+            if (offset > end)
+                page.free[end] = offset - end; // alignment padding
+            GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.offset, offset, allocation.size));
+            allocation.offset = offset;
+            end = offset + allocation.size;
+        }
+        if (end > 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, scratch.Get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer.Get());
+            GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, end));
+        }
+
+        if (end < page.size)
+            page.free[end] = page.size - end;
+        first = last;
+    }
+}
+
+BufferPool::Stats BufferPool::GetStats() const
+{
+    Stats stats;
+    stats.pages = (unsigned int)m_Pages.size();
+    stats.allocations = (unsigned int)(m_Allocations.size() - m_FreeHandles.size());
+    for (const Page& page : m_Pages)
+    {
+        std::size_t free = 0;
+        for (const auto& range : page.free)
+        {
+            free += range.second;
+            stats.largestFree = std::max(stats.largestFree, range.second);
+        }
+        stats.freeBytes += free;
+        stats.usedBytes += page.size - free;
+    }
+    return stats;
+}
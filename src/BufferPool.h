@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "GLHandle.h"
+
+// A few large GL buffers ("pages") handed out in offset/size pieces, so thousands
+// of small meshes cost a handful of buffer objects and share one vertex array per
+// page (see MeshBatch). Every page keeps its free ranges in an offset ordered map,
+// allocation is first fit and Free merges a range with its free neighbours.
+// Allocations are referred to by handle: Defragment packs each page to its front and
+// moves them, so read the offset back with Get rather than keeping it. Pages are
+// never deleted or renamed while the pool lives, vertex arrays built on them stay valid.
+// Pages are plain buffers, bind them to whatever target the data is for.
+class BufferPool
+{
+public:
+    using Handle = unsigned int;
+    static constexpr Handle kInvalid = ~0u;
+
+    struct Allocation
+    {
+        unsigned int page;
+        std::size_t offset;    // in bytes from the start of the page
+        std::size_t size;      // 0 once freed
+        std::size_t alignment;
+    };
+
+    struct Stats
+    {
+        unsigned int pages = 0;
+        unsigned int allocations = 0;
+        std::size_t usedBytes = 0;
+        std::size_t freeBytes = 0;
+        std::size_t largestFree = 0; // much smaller than freeBytes means fragmented
+    };
+
+private:
+    struct Page
+    {
+        BufferHandle buffer;
+        std::size_t size;
+        std::map<std::size_t, std::size_t> free; // offset -> size, never two adjacent
+    };
+
+    std::size_t m_PageSize;
+    std::vector<Page> m_Pages;
+    std::vector<Allocation> m_Allocations; // by handle
+    std::vector<Handle> m_FreeHandles;
+
+    static bool Carve(Page& page, std::size_t size, std::size_t alignment, std::size_t& offset);
+    unsigned int AddPage(std::size_t size);
+
+public:
+    // an allocation larger than pageSize gets a page of its own
+    explicit BufferPool(std::size_t pageSize = 4 * 1024 * 1024);
+
+    // offset a multiple of alignment (any value, not only powers of two, so a
+    // vertex stride works and offset / stride is the base vertex)
+    Handle Allocate(std::size_t size, std::size_t alignment = 4);
+    // Allocate, then Upload
+    Handle Allocate(const void* data, std::size_t size, std::size_t alignment = 4);
+    void Upload(Handle handle, const void* data, std::size_t size, std::size_t offset = 0);
+    void Free(Handle handle);
+
+    // moves every page's allocations to its front through one scratch buffer,
+    // glCopyBufferSubData only. between frames: draws already recorded with the old
+    // offsets would read the wrong data
+    void Defragment();
+
+    inline const Allocation& Get(Handle handle) const { return m_Allocations[handle]; }
+    inline unsigned int GetBuffer(unsigned int page) const { return m_Pages[page].buffer.Get(); }
+    inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+    Stats GetStats() const;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "VertexLayout.h"
+
+// the vertices the generators write, and how a vertex array reads them (Layout,
+// see VertexArray::AddBuffer)
+using PositionLayout = VertexLayout<Float2>;
+struct PositionVertex
+{
+    using Layout = PositionLayout;
+    float position[2];
+};
+VERTEX_LAYOUT(PositionVertex, PositionLayout);
+VERTEX_ATTRIBUTE(PositionVertex, position, PositionLayout, 0);
+
+using MorphLayout = VertexLayout<Float2, Float2>;
+struct MorphVertex
+{
+    using Layout = MorphLayout;
+    float position[2]; // at depth + 1
+    float parent[2];   // at depth
+};
+VERTEX_LAYOUT(MorphVertex, MorphLayout);
+VERTEX_ATTRIBUTE(MorphVertex, position, MorphLayout, 0);
+VERTEX_ATTRIBUTE(MorphVertex, parent, MorphLayout, 1);
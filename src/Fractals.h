@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "GeometrySink.h"
+#include "Profiler.h"
+
+// Fractal generators, templated on the destination (see GeometrySink.h).
+// Positions are xy pairs; the *Morph variants emit depth + 1 geometry with every
+// vertex followed by its position one level up, i.e. {x, y, parentX, parentY}.
+// Everything here is constexpr, so with a constexpr sink (BakedFractals.h) small
+// depths are evaluated by the compiler. No GL, the vertex structs the demos read
+// this data as are in FractalVertices.h.
+
+// floats written for a single triangle / a single starting segment
+constexpr std::size_t sierpinskiFloatCount(int depth)
+{
+    std::size_t triangles = 1;
+    for (int i = 0; i < depth; i++)
+        triangles *= 3;
+    return triangles * 3 * 2;
+}
+
+constexpr std::size_t kochSnowflakeFloatCount(int depth)
+{
+    return (std::size_t(1) << (2 * depth)) * 2 * 2;
+}
+
+constexpr std::size_t sierpinskiMorphFloatCount(int depth) { return sierpinskiFloatCount(depth + 1) * 2; }
+constexpr std::size_t kochSnowflakeMorphFloatCount(int depth) { return kochSnowflakeFloatCount(depth + 1) * 2; }
+
+template <typename Sink>
+constexpr void generateSierpinski(Sink& sink, const float p0[2], const float p1[2], const float p2[2], int depth)
+{
+    if (depth == 0)
+    {
+        // Base Case
+        const float triangle[6] = { p0[0], p0[1], p1[0], p1[1], p2[0], p2[1] };
+        sink.Write(triangle, 6);
+    }
+    else
+    {
+        // mid - point
+        float m0[2] = { (p0[0] + p1[0])/2, (p0[1]+p1[1])/2 };
+        float m1[2] = { (p1[0] + p2[0])/2, (p1[1]+p2[1])/2 };
+        float m2[2] = { (p0[0] + p2[0])/2, (p0[1]+p2[1])/2 };
+
+        // Recurse on the 3 new edges
+        generateSierpinski(sink, m2, m1, p2, depth - 1); // depth is the recursive variable
+        generateSierpinski(sink, p0, m0, m2, depth - 1);
+        generateSierpinski(sink, m0, p1, m1, depth - 1);
+    }
+}
+
+template <typename Sink>
+constexpr void generateSierpinskiMorph(Sink& sink, const float p0[2], const float p1[2], const float p2[2], int depth)
+{
+    float m0[2] = { (p0[0] + p1[0])/2, (p0[1]+p1[1])/2 };
+    float m1[2] = { (p1[0] + p2[0])/2, (p1[1]+p2[1])/2 };
+    float m2[2] = { (p0[0] + p2[0])/2, (p0[1]+p2[1])/2 };
+
+    if (depth == 0)
+    {
+        // each child is the parent shrunk towards one of its corners,
+        // so vertex i of a child starts on vertex i of the parent
+        const float children[36] = {
+            m2[0], m2[1], p0[0], p0[1],  m1[0], m1[1], p1[0], p1[1],  p2[0], p2[1], p2[0], p2[1],
+            p0[0], p0[1], p0[0], p0[1],  m0[0], m0[1], p1[0], p1[1],  m2[0], m2[1], p2[0], p2[1],
+            m0[0], m0[1], p0[0], p0[1],  p1[0], p1[1], p1[0], p1[1],  m1[0], m1[1], p2[0], p2[1]
+        };
+        sink.Write(children, 36);
+    }
+    else
+    {
+        generateSierpinskiMorph(sink, m2, m1, p2, depth - 1);
+        generateSierpinskiMorph(sink, p0, m0, m2, depth - 1);
+        generateSierpinskiMorph(sink, m0, p1, m1, depth - 1);
+    }
+}
+
+// splits p0 -> p1 into thirds and the bump point (perpendicular triangle).
+// the bump is the first third point plus the middle third rotated by 60 degrees,
+// so all four pieces are a third long. no libm call, the rotation is a constant
+constexpr void subdivideKochSegment(const float p0[2], const float p1[2], float p2[2], float p3[2], float bump[2])
+{
+    constexpr float cosAngle = 0.5f;                // cos(pi / 3)
+    constexpr float sinAngle = 0.866025403784438f;  // sin(pi / 3)
+
+    float dx = p1[0] - p0[0];
+    float dy = p1[1] - p0[1];
+
+    p2[0] = p0[0] + dx / 3.0f; p2[1] = p0[1] + dy / 3.0f;
+    p3[0] = p0[0] + 2.0f * dx / 3.0f; p3[1] = p0[1] + 2.0f * dy / 3.0f;
+
+    bump[0] = p2[0] + (dx * cosAngle - dy * sinAngle) / 3.0f;
+    bump[1] = p2[1] + (dx * sinAngle + dy * cosAngle) / 3.0f;
+}
+
+template <typename Sink>
+constexpr void generateKochSnowflake(Sink& sink, const float p0[2], const float p1[2], int depth)
+{
+    if (depth == 0)
+    {
+        // Base case: add the line from p0 to p1
+        const float line[4] = { p0[0], p0[1], p1[0], p1[1] };
+        sink.Write(line, 4);
+    }
+    else
+    {
+        float p2[2] = {}, p3[2] = {}, bump[2] = {};
+        subdivideKochSegment(p0, p1, p2, p3, bump);
+
+        // Recurse on the 4 new edges
+        generateKochSnowflake(sink, p0, p2, depth - 1);
+        generateKochSnowflake(sink, p2, bump, depth - 1);
+        generateKochSnowflake(sink, bump, p3, depth - 1);
+        generateKochSnowflake(sink, p3, p1, depth - 1);
+    }
+}
+
+template <typename Sink>
+constexpr void generateKochSnowflakeMorph(Sink& sink, const float p0[2], const float p1[2], int depth)
+{
+    float p2[2] = {}, p3[2] = {}, bump[2] = {};
+    subdivideKochSegment(p0, p1, p2, p3, bump);
+
+    if (depth == 0)
+    {
+        // p2 and p3 already lie on the parent segment, the bump starts flat between them
+        float foot[2] = { (p2[0] + p3[0]) / 2.0f, (p2[1] + p3[1]) / 2.0f };
+
+        const float segments[32] = {
+            p0[0], p0[1], p0[0], p0[1],        p2[0], p2[1], p2[0], p2[1],
+            p2[0], p2[1], p2[0], p2[1],        bump[0], bump[1], foot[0], foot[1],
+            bump[0], bump[1], foot[0], foot[1], p3[0], p3[1], p3[0], p3[1],
+            p3[0], p3[1], p3[0], p3[1],        p1[0], p1[1], p1[0], p1[1]
+        };
+        sink.Write(segments, 32);
+    }
+    else
+    {
+        generateKochSnowflakeMorph(sink, p0, p2, depth - 1);
+        generateKochSnowflakeMorph(sink, p2, bump, depth - 1);
+        generateKochSnowflakeMorph(sink, bump, p3, depth - 1);
+        generateKochSnowflakeMorph(sink, p3, p1, depth - 1);
+    }
+}
+
+// std::vector<float>& overloads, for callers that still just want a vector. traced,
+// the constexpr templates above can't be
+inline void generateSierpinski(std::vector<float>& vertices, const float p0[2], const float p1[2], const float p2[2], int depth)
+{
+    PROFILE_ZONE("generateSierpinski");
+    VectorSink sink(vertices);
+    generateSierpinski(sink, p0, p1, p2, depth);
+}
+
+inline void generateSierpinskiMorph(std::vector<float>& vertices, const float p0[2], const float p1[2], const float p2[2], int depth)
+{
+    PROFILE_ZONE("generateSierpinskiMorph");
+    VectorSink sink(vertices);
+    generateSierpinskiMorph(sink, p0, p1, p2, depth);
+}
+
+inline void generateKochSnowflake(std::vector<float>& vertices, const float p0[2], const float p1[2], int depth)
+{
+    PROFILE_ZONE("generateKochSnowflake");
+    VectorSink sink(vertices);
+    generateKochSnowflake(sink, p0, p1, depth);
+}
+
+inline void generateKochSnowflakeMorph(std::vector<float>& vertices, const float p0[2], const float p1[2], int depth)
+{
+    PROFILE_ZONE("generateKochSnowflakeMorph");
+    VectorSink sink(vertices);
+    generateKochSnowflakeMorph(sink, p0, p1, depth);
+}
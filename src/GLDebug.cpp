@@ -0,0 +1,190 @@
+#include "GLDebug.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    enum class Mode { Off, Async, Sync, Poll };
+
+    Mode s_Mode = Mode::Off; // until GLDebugInit
+    bool s_Groups = false;   // push/pop debug group available
+
+    Mode RequestedMode()
+    {
+        const char* value = std::getenv("MATH_ENGINE_GL_DEBUG");
+        if (!value || !*value || std::strcmp(value, "async") == 0)
+            return Mode::Async;
+        if (std::strcmp(value, "off") == 0 || std::strcmp(value, "0") == 0)
+            return Mode::Off;
+        if (std::strcmp(value, "sync") == 0)
+        {
+#ifdef NDEBUG
+            std::cout << "MATH_ENGINE_GL_DEBUG=sync needs a debug build, using async" << std::endl;
+            return Mode::Async;
+#else
+            return Mode::Sync;
+#endif
+        }
+        std::cout << "MATH_ENGINE_GL_DEBUG=" << value << " unknown (async, sync or off), using async" << std::endl;
+        return Mode::Async;
+    }
+
+#ifndef NDEBUG
+    // the last GLCall. written by the GL thread, read by the callback, which in
+    // async mode may run on a driver thread: relaxed atomics, plain stores on x86
+    std::atomic<const char*> s_Function{ nullptr };
+    std::atomic<const char*> s_File{ nullptr };
+    std::atomic<int> s_Line{ 0 };
+    std::atomic<bool> s_InCall{ false };
+    std::atomic<bool> s_Failed{ false };
+
+    // open debug groups, only read by the callback in sync mode (same thread)
+    std::vector<const char*> s_GroupStack;
+
+    void PrintCallSite(std::ostream& out)
+    {
+        const char* function = s_Function.load(std::memory_order_relaxed);
+        if (!function)
+            return;
+        const char* where = s_Mode != Mode::Sync ? "near" : s_InCall.load(std::memory_order_relaxed) ? "in" : "after";
+        out << " " << where << " " << function << " " << s_File.load(std::memory_order_relaxed) << " "
+            << s_Line.load(std::memory_order_relaxed);
+        if (s_Mode == Mode::Sync)
+        {
+            for (const char* group : s_GroupStack)
+                out << " [" << group << "]";
+        }
+    }
+#endif
+
+    const char* TypeName(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_DEBUG_TYPE_ERROR: return "Error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+        default: return "Message";
+        }
+    }
+
+    void GLAPIENTRY OnDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                   const GLchar* message, const void* userParam)
+    {
+        if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP)
+            return;
+
+        std::cout << "[OpenGL " << TypeName(type) << "] (" << id << ") " << message;
+#ifndef NDEBUG
+        PrintCallSite(std::cout);
+        if (type == GL_DEBUG_TYPE_ERROR && s_Mode == Mode::Sync)
+            s_Failed.store(true, std::memory_order_relaxed); // GLEndCall traps, not the driver's stack
+#endif
+        std::cout << std::endl;
+    }
+}
+
+void GLDebugWindowHints()
+{
+#ifndef NDEBUG
+    if (RequestedMode() != Mode::Off)
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+}
+
+void GLDebugInit()
+{
+    Mode mode = RequestedMode();
+    if (mode == Mode::Off)
+        return;
+
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+    {
+#ifndef NDEBUG
+        std::cout << "No KHR_debug, GL errors are polled after every GLCall" << std::endl;
+        s_Mode = Mode::Poll;
+#endif
+        return;
+    }
+
+    s_Mode = mode;
+    s_Groups = true;
+    glEnable(GL_DEBUG_OUTPUT);
+    if (mode == Mode::Sync)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(OnDebugMessage, nullptr);
+
+#ifdef NDEBUG
+    // errors and anything the driver thinks is serious, nothing chatty
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_HIGH, 0, nullptr, GL_TRUE);
+#else
+    // buffer placement hints and the like, every frame on some drivers
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+#endif
+}
+
+#ifndef NDEBUG
+void GLBeginCall(const char* function, const char* file, int line)
+{
+    s_Function.store(function, std::memory_order_relaxed);
+    s_File.store(file, std::memory_order_relaxed);
+    s_Line.store(line, std::memory_order_relaxed);
+    if (s_Mode == Mode::Sync)
+    {
+        s_InCall.store(true, std::memory_order_relaxed);
+        s_Failed.store(false, std::memory_order_relaxed); // an unwrapped call's error was reported already
+    }
+    else if (s_Mode == Mode::Poll)
+    {
+        while (glGetError() != GL_NO_ERROR);
+    }
+}
+
+bool GLEndCall()
+{
+    if (s_Mode == Mode::Sync)
+    {
+        s_InCall.store(false, std::memory_order_relaxed);
+        return !s_Failed.load(std::memory_order_relaxed);
+    }
+    if (s_Mode == Mode::Poll)
+    {
+        while (GLenum error = glGetError())
+        {
+            std::cout << "[OpenGL Error] (" << error << ") " << s_Function.load(std::memory_order_relaxed) << " "
+                      << s_File.load(std::memory_order_relaxed) << " " << s_Line.load(std::memory_order_relaxed) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+GLDebugGroup::GLDebugGroup(const char* name)
+{
+    if (!s_Groups)
+        return;
+    s_GroupStack.push_back(name);
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+GLDebugGroup::~GLDebugGroup()
+{
+    if (!s_Groups)
+        return;
+    glPopDebugGroup();
+    s_GroupStack.pop_back();
+}
+#endif
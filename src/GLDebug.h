@@ -0,0 +1,57 @@
+#pragma once
+
+#include <csignal>
+
+// GL errors come from a KHR_debug message callback (GL 4.3) instead of a
+// glGetError round trip around every call. GLCall only remembers where it is, a
+// couple of stores, and the callback reports the last call site it saw.
+//
+// MATH_ENGINE_GL_DEBUG picks the mode at startup:
+//     async (default) the driver reports whenever it likes, possibly from its own
+//                     thread and a few calls late, the call site is "near"
+//     sync            every message is delivered inside the call that caused it,
+//                     GLCall traps right there. slower, for pinning a bug down
+//     off             nothing registered
+// Without KHR_debug GLCall falls back to polling glGetError like it used to.
+//
+// NDEBUG builds compile GLCall down to the bare call and drop sync mode and the
+// polling fallback. The async callback stays, filtered to errors and high
+// severity, so production builds still report them without a per call cost.
+
+#define ASSERT(x) if (!(x)) raise(SIGTRAP); // macro
+
+#ifdef NDEBUG
+#define GLCall(x) x
+#else
+#define GLCall(x) GLBeginCall(#x, __FILE__, __LINE__);\
+    x;\
+    ASSERT(GLEndCall())
+#endif
+
+// once, right after glewInit. a debug context (GLFW_OPENGL_DEBUG_CONTEXT) gets
+// the most out of the drivers, see GLDebugWindowHints
+void GLDebugInit();
+// before glfwCreateWindow: asks for a debug context unless NDEBUG or the mode is off
+void GLDebugWindowHints();
+
+#ifndef NDEBUG
+void GLBeginCall(const char* function, const char* file, int line);
+// false once an error was reported for this call (sync mode and polling only)
+bool GLEndCall();
+#endif
+
+// names a stretch of GL work. shows up in the callback's reports and in
+// frame debuggers (RenderDoc, apitrace). compiled out with NDEBUG
+class GLDebugGroup
+{
+public:
+#ifdef NDEBUG
+    explicit GLDebugGroup(const char*) {}
+#else
+    explicit GLDebugGroup(const char* name);
+    ~GLDebugGroup();
+#endif
+
+    GLDebugGroup(const GLDebugGroup&) = delete;
+    GLDebugGroup& operator=(const GLDebugGroup&) = delete;
+};
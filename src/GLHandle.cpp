@@ -0,0 +1,74 @@
+#include "GLHandle.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdlib>
+#include <cstring>
+
+bool HasDirectStateAccess()
+{
+    // fixed for the whole run, an object is always edited the way it was created
+    static const bool available = []
+    {
+        const char* value = std::getenv("MATH_ENGINE_NO_DSA");
+        bool disabled = value && *value && std::strcmp(value, "0") != 0;
+        return !disabled && (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+    }();
+    return available;
+}
+
+unsigned int BufferTraits::Create()
+{
+    unsigned int id = 0;
+    if (HasDirectStateAccess())
+        glCreateBuffers(1, &id);
+    else
+        glGenBuffers(1, &id);
+    return id;
+}
+
+void BufferTraits::Destroy(unsigned int id)
+{
+    GLStateCache::Get().OnDeleteBuffer(id);
+    glDeleteBuffers(1, &id);
+}
+
+unsigned int VertexArrayTraits::Create()
+{
+    unsigned int id = 0;
+    if (HasDirectStateAccess())
+        glCreateVertexArrays(1, &id);
+    else
+        glGenVertexArrays(1, &id);
+    return id;
+}
+
+void VertexArrayTraits::Destroy(unsigned int id)
+{
+    GLStateCache::Get().OnDeleteVertexArray(id);
+    glDeleteVertexArrays(1, &id);
+}
+
+unsigned int ProgramTraits::Create()
+{
+    return glCreateProgram();
+}
+
+void ProgramTraits::Destroy(unsigned int id)
+{
+    GLStateCache::Get().OnDeleteProgram(id);
+    glDeleteProgram(id);
+}
+
+unsigned int QueryTraits::Create()
+{
+    unsigned int id = 0;
+    glGenQueries(1, &id);
+    return id;
+}
+
+void QueryTraits::Destroy(unsigned int id)
+{
+    glDeleteQueries(1, &id);
+}
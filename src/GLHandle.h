@@ -0,0 +1,87 @@
+#pragma once
+
+// Owns one GL object name and deletes it exactly once. Move only: the moved from
+// handle is left at 0 and deletes nothing, so classes built on it can be stored by
+// value in std::vector or a cache and relocated without a single driver call.
+// Traits provide
+//     static unsigned int Create();
+//     static void Destroy(unsigned int id);
+template <typename Traits>
+class GLHandle
+{
+private:
+    unsigned int m_ID;
+
+public:
+    GLHandle() : m_ID(0) {}
+    // takes over a name created elsewhere (glCreateProgram in a compile queue, a cached binary, ...)
+    explicit GLHandle(unsigned int id) : m_ID(id) {}
+    ~GLHandle() { Reset(); }
+
+    static GLHandle Create() { return GLHandle(Traits::Create()); }
+
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    GLHandle(GLHandle&& other) noexcept : m_ID(other.Release()) {}
+    GLHandle& operator=(GLHandle&& other) noexcept
+    {
+        if (this != &other)
+            Reset(other.Release());
+        return *this;
+    }
+
+    // deletes the current object, if any, and owns id from now on
+    void Reset(unsigned int id = 0)
+    {
+        if (m_ID != 0)
+            Traits::Destroy(m_ID);
+        m_ID = id;
+    }
+
+    // hands the name over without deleting it
+    unsigned int Release()
+    {
+        unsigned int id = m_ID;
+        m_ID = 0;
+        return id;
+    }
+
+    inline unsigned int Get() const { return m_ID; }
+    inline explicit operator bool() const { return m_ID != 0; }
+};
+
+// GL 4.5 / ARB_direct_state_access: buffers and vertex arrays are created with
+// glCreate* and edited by name, nothing gets bound to change them. Decided on the
+// first call (needs a context), MATH_ENGINE_NO_DSA=1 forces the bind-to-edit path
+bool HasDirectStateAccess();
+
+// Destroy also tells GLStateCache, a later object may get the same name
+struct BufferTraits
+{
+    static unsigned int Create();
+    static void Destroy(unsigned int id);
+};
+
+struct VertexArrayTraits
+{
+    static unsigned int Create();
+    static void Destroy(unsigned int id);
+};
+
+struct ProgramTraits
+{
+    static unsigned int Create();
+    static void Destroy(unsigned int id);
+};
+
+struct QueryTraits
+{
+    static unsigned int Create();
+    static void Destroy(unsigned int id);
+};
+
+using BufferHandle = GLHandle<BufferTraits>;
+using VertexArrayHandle = GLHandle<VertexArrayTraits>;
+using ProgramHandle = GLHandle<ProgramTraits>;
+using QueryHandle = GLHandle<QueryTraits>;
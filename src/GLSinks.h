@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+
+#include "GeometrySink.h"
+#include "StreamingVertexBuffer.h"
+#include "VertexBuffer.h"
+
+// The GeometrySink.h sinks that write into GL buffers, kept apart so the generators
+// don't depend on GL.
+
+// writes straight into a VertexBuffer's storage, unmapped when the sink goes out of scope.
+// the buffer has to be at least capacity floats, e.g. VertexBuffer(nullptr, bytes)
+class MappedBufferSink : public SpanSink
+{
+private:
+    const VertexBuffer& m_Buffer;
+
+public:
+    MappedBufferSink(const VertexBuffer& vb, std::size_t capacity)
+        : SpanSink(nullptr, capacity), m_Buffer(vb)
+    {
+        m_Data = static_cast<float*>(vb.Map(capacity * sizeof(float)));
+        if (!m_Data)
+            m_Capacity = 0;
+    }
+
+    ~MappedBufferSink()
+    {
+        if (m_Data)
+            m_Buffer.Unmap();
+    }
+
+    MappedBufferSink(const MappedBufferSink&) = delete;
+    MappedBufferSink& operator=(const MappedBufferSink&) = delete;
+};
+
+// writes into the next free region of a StreamingVertexBuffer, committed when the sink
+// goes out of scope. the region starts on a vertex boundary, see GetFirstVertex
+class StreamingBufferSink : public SpanSink
+{
+private:
+    StreamingVertexBuffer& m_Buffer;
+    StreamingVertexBuffer::Region m_Region;
+    std::size_t m_Stride;
+
+public:
+    // capacity in floats, stride in bytes
+    StreamingBufferSink(StreamingVertexBuffer& buffer, std::size_t capacity, std::size_t stride)
+        : SpanSink(nullptr, 0), m_Buffer(buffer), m_Stride(stride)
+    {
+        m_Region = buffer.Allocate(capacity * sizeof(float), stride);
+        m_Data = static_cast<float*>(m_Region.data);
+        m_Capacity = m_Data ? capacity : 0;
+    }
+
+    ~StreamingBufferSink() { m_Buffer.Commit(m_Region); }
+
+    StreamingBufferSink(const StreamingBufferSink&) = delete;
+    StreamingBufferSink& operator=(const StreamingBufferSink&) = delete;
+
+    inline const StreamingVertexBuffer::Region& GetRegion() const { return m_Region; }
+    inline unsigned int GetFirstVertex() const { return (unsigned int)(m_Region.offset / m_Stride); }
+};
@@ -0,0 +1,146 @@
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+std::uint64_t GLStateCache::Counters::GetIssued() const
+{
+    std::uint64_t total = 0;
+    for (std::uint64_t count : issued)
+        total += count;
+    return total;
+}
+
+std::uint64_t GLStateCache::Counters::GetElided() const
+{
+    std::uint64_t total = 0;
+    for (std::uint64_t count : elided)
+        total += count;
+    return total;
+}
+
+GLStateCache::GLStateCache()
+{
+    Invalidate();
+}
+
+GLStateCache& GLStateCache::Get()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (Elide(Program, m_Program == program))
+        return;
+    glUseProgram(program);
+    m_Program = program;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (Elide(VertexArray, m_VertexArray == vertexArray))
+        return;
+    glBindVertexArray(vertexArray);
+    m_VertexArray = vertexArray;
+
+    // the element buffer binding comes with the vertex array, known only if we saw it set there
+    auto elementBuffer = m_VertexArrayElementBuffers.find(vertexArray);
+    m_ElementBuffer = elementBuffer != m_VertexArrayElementBuffers.end() ? elementBuffer->second : kUnknown;
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    unsigned int* shadow = nullptr;
+    BindKind kind = ArrayBuffer;
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER: shadow = &m_ArrayBuffer; kind = ArrayBuffer; break;
+    case GL_ELEMENT_ARRAY_BUFFER: shadow = &m_ElementBuffer; kind = ElementBuffer; break;
+    case GL_UNIFORM_BUFFER: shadow = &m_UniformBuffer; kind = UniformBuffer; break;
+    default:
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (Elide(kind, *shadow == buffer))
+        return;
+    glBindBuffer(target, buffer);
+    *shadow = buffer;
+
+    if (target == GL_ELEMENT_ARRAY_BUFFER && m_VertexArray != kUnknown)
+        m_VertexArrayElementBuffers[m_VertexArray] = buffer;
+}
+
+void GLStateCache::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer,
+                                   std::intptr_t offset, std::intptr_t size)
+{
+    if (target != GL_UNIFORM_BUFFER || index >= kMaxUniformBindings)
+    {
+        glBindBufferRange(target, index, buffer, offset, size);
+        if (target == GL_UNIFORM_BUFFER)
+            m_UniformBuffer = buffer; // also sets the generic binding
+        return;
+    }
+
+    BufferRange& range = m_UniformRanges[index];
+    if (Elide(UniformBufferRange, range.buffer == buffer && range.offset == offset && range.size == size))
+        return;
+    glBindBufferRange(target, index, buffer, offset, size);
+    range = { buffer, offset, size };
+    m_UniformBuffer = buffer;
+}
+
+void GLStateCache::OnDeleteProgram(unsigned int program)
+{
+    // a deleted program stays in use until another is bound, so just forget it
+    if (m_Program == program)
+        m_Program = kUnknown;
+}
+
+void GLStateCache::OnDeleteVertexArray(unsigned int vertexArray)
+{
+    m_VertexArrayElementBuffers.erase(vertexArray);
+    if (m_VertexArray == vertexArray) // deleting the bound vertex array binds 0
+    {
+        m_VertexArray = 0;
+        auto elementBuffer = m_VertexArrayElementBuffers.find(0);
+        m_ElementBuffer = elementBuffer != m_VertexArrayElementBuffers.end() ? elementBuffer->second : kUnknown;
+    }
+}
+
+void GLStateCache::OnDeleteBuffer(unsigned int buffer)
+{
+    if (m_ArrayBuffer == buffer)
+        m_ArrayBuffer = 0;
+    if (m_ElementBuffer == buffer)
+        m_ElementBuffer = 0;
+    if (m_UniformBuffer == buffer)
+        m_UniformBuffer = 0;
+    for (BufferRange& range : m_UniformRanges)
+        if (range.buffer == buffer)
+            range = BufferRange();
+
+    // only detached from the bound vertex array, the others keep a dangling name
+    for (auto& [vertexArray, elementBuffer] : m_VertexArrayElementBuffers)
+        if (elementBuffer == buffer)
+            elementBuffer = vertexArray == m_VertexArray ? 0 : kUnknown;
+}
+
+void GLStateCache::OnVertexArrayElementBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+    m_VertexArrayElementBuffers[vertexArray] = buffer;
+    if (m_VertexArray == vertexArray)
+        m_ElementBuffer = buffer;
+}
+
+void GLStateCache::Invalidate()
+{
+    m_Program = kUnknown;
+    m_VertexArray = kUnknown;
+    m_ArrayBuffer = kUnknown;
+    m_ElementBuffer = kUnknown;
+    m_UniformBuffer = kUnknown;
+    for (BufferRange& range : m_UniformRanges)
+        range = BufferRange();
+    m_VertexArrayElementBuffers.clear();
+}
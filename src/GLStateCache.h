@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+// Shadow copy of the binding state, so Bind() calls that wouldn't change anything
+// never reach the driver. Every class that binds (Shader, VertexArray, VertexBuffer,
+// IndexBuffer, UniformRingBuffer) goes through it; code that calls glBind* directly
+// has to Invalidate() afterwards. One context, render thread only.
+class GLStateCache
+{
+public:
+    enum BindKind { Program, VertexArray, ArrayBuffer, ElementBuffer, UniformBuffer, UniformBufferRange, KindCount };
+
+    struct Counters
+    {
+        std::uint64_t issued[KindCount] = {};
+        std::uint64_t elided[KindCount] = {};
+
+        std::uint64_t GetIssued() const;
+        std::uint64_t GetElided() const;
+    };
+
+private:
+    static constexpr unsigned int kUnknown = ~0u;
+    static constexpr unsigned int kMaxUniformBindings = 16; // ranges tracked per binding point
+
+    struct BufferRange
+    {
+        unsigned int buffer = kUnknown;
+        std::intptr_t offset = 0;
+        std::intptr_t size = 0;
+    };
+
+    unsigned int m_Program;
+    unsigned int m_VertexArray;
+    unsigned int m_ArrayBuffer;
+    unsigned int m_ElementBuffer;   // part of the vertex array state, follows m_VertexArray
+    unsigned int m_UniformBuffer;   // the generic GL_UNIFORM_BUFFER binding
+    BufferRange m_UniformRanges[kMaxUniformBindings];
+    // element buffer last seen bound in each vertex array, restored with it
+    std::unordered_map<unsigned int, unsigned int> m_VertexArrayElementBuffers;
+    Counters m_Counters;
+
+    inline bool Elide(BindKind kind, bool unchanged)
+    {
+        (unchanged ? m_Counters.elided : m_Counters.issued)[kind]++;
+        return unchanged;
+    }
+
+public:
+    GLStateCache();
+
+    static GLStateCache& Get();
+
+    void UseProgram(unsigned int program);
+    void BindVertexArray(unsigned int vertexArray);
+    // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER and GL_UNIFORM_BUFFER are tracked, other targets pass through
+    void BindBuffer(unsigned int target, unsigned int buffer);
+    void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, std::intptr_t offset, std::intptr_t size);
+
+    // call right before deleting, GL drops the bindings of a deleted object and
+    // a later object may get the same name
+    void OnDeleteProgram(unsigned int program);
+    void OnDeleteVertexArray(unsigned int vertexArray);
+    void OnDeleteBuffer(unsigned int buffer);
+    // glVertexArrayElementBuffer changed a vertex array's element buffer without binding it
+    void OnVertexArrayElementBuffer(unsigned int vertexArray, unsigned int buffer);
+
+    // forget everything, the next bind of each kind goes to the driver
+    void Invalidate();
+
+    inline const Counters& GetCounters() const { return m_Counters; }
+    inline void ResetCounters() { m_Counters = Counters(); }
+};
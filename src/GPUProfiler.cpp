@@ -0,0 +1,131 @@
+#include "GPUProfiler.h"
+#include "Renderer.h"
+
+#include <GL/glew.h>
+
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+GPUProfiler::GPUProfiler(bool enabled)
+    : m_Enabled(enabled && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)), m_Current(0), m_Dropped(0)
+{
+    if (enabled && !m_Enabled)
+        std::cout << "GPU profiling needs timer queries (GL 3.3), disabled" << std::endl;
+}
+
+unsigned int GPUProfiler::Timestamp(Frame& frame)
+{
+    if (frame.used == frame.queries.size())
+        frame.queries.push_back(QueryHandle::Create());
+    unsigned int index = frame.used++;
+    // queued with the commands before it, doesn't wait for anything
+    GLCall(glQueryCounter(frame.queries[index].Get(), GL_TIMESTAMP));
+    return index;
+}
+
+void GPUProfiler::Collect(Frame& frame)
+{
+    // a frame that was never ended has nothing to wait on
+    if (frame.passes.empty() || frame.passes[0].end == kNoQuery)
+        return;
+
+    // the frame pass ends last, once its timestamp is there all of them are
+    GLint available = 0;
+    GLCall(glGetQueryObjectiv(frame.queries[frame.passes[0].end].Get(), GL_QUERY_RESULT_AVAILABLE, &available));
+    if (!available)
+    {
+        m_Dropped++;
+        return;
+    }
+
+    for (const Pass& pass : frame.passes)
+    {
+        if (pass.end == kNoQuery)
+            continue; // still open when the frame was replaced
+        GLuint64 begin = 0, end = 0;
+        GLCall(glGetQueryObjectui64v(frame.queries[pass.begin].Get(), GL_QUERY_RESULT, &begin));
+        GLCall(glGetQueryObjectui64v(frame.queries[pass.end].Get(), GL_QUERY_RESULT, &end));
+        double ms = (end - begin) / 1.0e6;
+
+        PassStats* stats = nullptr;
+        for (PassStats& s : m_Stats)
+        {
+            if (s.depth == pass.depth && (s.name == pass.name || std::strcmp(s.name, pass.name) == 0))
+            {
+                stats = &s;
+                break;
+            }
+        }
+        if (!stats)
+        {
+            m_Stats.push_back({ pass.name, pass.depth, 0.0, 0.0, 0 });
+            stats = &m_Stats.back();
+        }
+        stats->totalMs += ms;
+        stats->lastMs = ms;
+        stats->frames++;
+    }
+}
+
+void GPUProfiler::BeginFrame()
+{
+    if (!m_Enabled)
+        return;
+
+    m_Current = (m_Current + 1) % kFrameLatency;
+    Frame& frame = m_Frames[m_Current];
+    Collect(frame);
+    frame.passes.clear();
+    frame.used = 0;
+    m_Open.clear();
+
+    m_Open.push_back(0);
+    frame.passes.push_back({ "frame", 0, Timestamp(frame), kNoQuery });
+}
+
+void GPUProfiler::EndFrame()
+{
+    if (!m_Enabled)
+        return;
+    while (!m_Open.empty())
+        EndPass(); // closes "frame" and anything left open
+}
+
+void GPUProfiler::BeginPass(const char* name)
+{
+    // outside BeginFrame / EndFrame there is no frame to time it in
+    if (!m_Enabled || m_Open.empty())
+        return;
+    Frame& frame = m_Frames[m_Current];
+    unsigned int depth = (unsigned int)m_Open.size();
+    m_Open.push_back((unsigned int)frame.passes.size());
+    frame.passes.push_back({ name, depth, Timestamp(frame), kNoQuery });
+}
+
+void GPUProfiler::EndPass()
+{
+    if (!m_Enabled || m_Open.empty())
+        return;
+    Frame& frame = m_Frames[m_Current];
+    frame.passes[m_Open.back()].end = Timestamp(frame);
+    m_Open.pop_back();
+}
+
+void GPUProfiler::Report(std::ostream& out) const
+{
+    if (!m_Enabled)
+        return;
+    out << "GPU time per pass (average / last, ms)";
+    if (m_Dropped > 0)
+        out << ", " << m_Dropped << " frame(s) not ready in time";
+    out << std::endl;
+    for (const PassStats& stats : m_Stats)
+    {
+        out << "  " << std::string(stats.depth * 2, ' ') << std::left << std::setw(20 - stats.depth * 2) << stats.name
+            << std::right << std::fixed << std::setprecision(3) << std::setw(8) << stats.GetAverageMs() << " / "
+            << stats.lastMs << std::defaultfloat << std::endl;
+    }
+}
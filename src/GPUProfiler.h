@@ -0,0 +1,101 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "GLHandle.h"
+
+// GPU time per named pass, from GL_TIMESTAMP queries (GL 3.3 / ARB_timer_query).
+// Timestamps rather than GL_TIME_ELAPSED so passes can nest. Each frame's queries
+// are read kFrameLatency frames later, when the GPU is long done with them, so
+// nothing ever waits on a result; a frame that still isn't done by then is
+// dropped and counted instead.
+//
+//     profiler.BeginFrame();
+//     {
+//         GPUProfiler::Scope pass(profiler, "gallery");
+//         ... GL calls ...
+//     }
+//     profiler.EndFrame();
+//
+// Pass names are string literals, they are kept by pointer. Passes begun outside a
+// frame are ignored. Every call is a no-op when the profiler is disabled or the
+// context has no timer queries.
+class GPUProfiler
+{
+public:
+    static constexpr unsigned int kFrameLatency = 4;
+
+    struct PassStats
+    {
+        const char* name;
+        unsigned int depth;    // 0 for the frame itself
+        double totalMs;
+        double lastMs;
+        unsigned int frames;   // frames the pass was measured in
+
+        inline double GetAverageMs() const { return frames ? totalMs / frames : 0.0; }
+    };
+
+    class Scope
+    {
+    private:
+        GPUProfiler& m_Profiler;
+
+    public:
+        Scope(GPUProfiler& profiler, const char* name) : m_Profiler(profiler) { m_Profiler.BeginPass(name); }
+        ~Scope() { m_Profiler.EndPass(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    struct Pass
+    {
+        const char* name;
+        unsigned int depth;
+        unsigned int begin; // query indices in the frame
+        unsigned int end;   // kNoQuery until the pass is ended
+    };
+
+    static constexpr unsigned int kNoQuery = ~0u;
+
+    struct Frame
+    {
+        std::vector<QueryHandle> queries; // grows to the busiest frame, then reused
+        std::vector<Pass> passes;
+        unsigned int used = 0;
+    };
+
+    bool m_Enabled;
+    Frame m_Frames[kFrameLatency];
+    unsigned int m_Current;
+    std::vector<unsigned int> m_Open; // passes begun and not ended, innermost last
+    std::vector<PassStats> m_Stats;   // in the order the passes were first seen
+    unsigned int m_Dropped;
+
+    unsigned int Timestamp(Frame& frame);
+    void Collect(Frame& frame);
+
+public:
+    // disabled, or without timer queries, it never touches GL
+    explicit GPUProfiler(bool enabled);
+
+    GPUProfiler(const GPUProfiler&) = delete;
+    GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+    // reads back the frame issued kFrameLatency frames ago, then opens a "frame" pass
+    void BeginFrame();
+    void EndFrame();
+
+    void BeginPass(const char* name);
+    void EndPass();
+
+    inline bool IsEnabled() const { return m_Enabled; }
+    inline const std::vector<PassStats>& GetStats() const { return m_Stats; }
+    inline unsigned int GetDroppedFrames() const { return m_Dropped; }
+
+    // average and last GPU time of every pass, nested passes indented
+    void Report(std::ostream& out) const;
+};
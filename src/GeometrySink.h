@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Destinations for the fractal generators in Fractals.h. A sink only needs
+//     void Write(const float* data, std::size_t count);
+// the generators are templated on it, so each one of these inlines into the recursion.
+// Standard library only, the sinks that write into GL buffers are in GLSinks.h.
+
+// appends to a std::vector, what the generators used to hard-code
+class VectorSink
+{
+private:
+    std::vector<float>& m_Vertices;
+
+public:
+    explicit VectorSink(std::vector<float>& vertices)
+        : m_Vertices(vertices) {}
+
+    inline void Reserve(std::size_t count) { m_Vertices.reserve(m_Vertices.size() + count); }
+    inline void Write(const float* data, std::size_t count) { m_Vertices.insert(m_Vertices.end(), data, data + count); }
+};
+
+// fills caller owned memory, anything past the capacity is dropped and flagged
+class SpanSink
+{
+protected:
+    float* m_Data;
+    std::size_t m_Capacity;
+    std::size_t m_Size;
+    bool m_Overflowed;
+
+public:
+    SpanSink(float* data, std::size_t capacity)
+        : m_Data(data), m_Capacity(capacity), m_Size(0), m_Overflowed(false) {}
+
+    inline void Write(const float* data, std::size_t count)
+    {
+        if (m_Size + count > m_Capacity)
+        {
+            m_Overflowed = true;
+            return;
+        }
+        std::memcpy(m_Data + m_Size, data, count * sizeof(float));
+        m_Size += count;
+    }
+
+    inline std::size_t GetSize() const { return m_Size; } // in floats
+    inline bool Overflowed() const { return m_Overflowed; }
+};
+
+// raw floats on disk in the host's byte order, batched so the recursion never hits the
+// stream per vertex. check Close, a failed write is only seen there
+class FileSink
+{
+private:
+    std::ofstream m_Stream;
+    std::vector<float> m_Pending;
+    std::size_t m_Written;
+
+    void Flush()
+    {
+        m_Stream.write(reinterpret_cast<const char*>(m_Pending.data()), m_Pending.size() * sizeof(float));
+        m_Written += m_Pending.size();
+        m_Pending.clear();
+    }
+
+public:
+    explicit FileSink(const std::string& filepath, std::size_t batch = 16384)
+        : m_Stream(filepath, std::ios::binary), m_Written(0)
+    {
+        m_Pending.reserve(batch);
+    }
+
+    // writes what is still batched and closes the file. false if the file couldn't be
+    // opened or any write failed, e.g. on a full disk. the destructor closes too, but
+    // can't report it
+    bool Close()
+    {
+        if (m_Stream.is_open())
+        {
+            Flush();
+            m_Stream.close();
+        }
+        return !m_Stream.fail();
+    }
+
+    ~FileSink() { Close(); }
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    inline void Write(const float* data, std::size_t count)
+    {
+        if (m_Pending.size() + count > m_Pending.capacity())
+            Flush();
+        m_Pending.insert(m_Pending.end(), data, data + count);
+    }
+
+    inline bool IsOpen() const { return m_Stream.is_open(); }
+    inline std::size_t GetSize() const { return m_Written + m_Pending.size(); } // in floats
+};
+
+// only counts, for sizing spans and buffers up front or quick stats
+class CountingSink
+{
+private:
+    std::size_t m_Size = 0;
+
+public:
+    inline void Write(const float*, std::size_t count) { m_Size += count; }
+    inline std::size_t GetSize() const { return m_Size; } // in floats
+};
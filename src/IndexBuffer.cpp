@@ -1,29 +1,33 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 #include <csignal>
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    :m_Count(count)
+    :m_RendererID(BufferHandle::Create()), m_Count(count)
 {
+    PROFILE_ZONE("IndexBuffer upload");
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-    glGenBuffers(1, &m_RendererID); // an id for the object, hence the pointer
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    if (HasDirectStateAccess())
+    {
+        // not attached to any vertex array here, see VertexArray::SetIndexBuffer
+        GLCall(glNamedBufferStorage(m_RendererID.Get(), count * sizeof(unsigned int), data, 0));
+        return;
+    }
+
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID.Get());
     //the line below links the buffer with the vao
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW); // this size is in bytes
 }
 
-IndexBuffer::~IndexBuffer()
-{
-    glDeleteBuffers(1, &m_RendererID);
-}
-
 void IndexBuffer::Bind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID.Get());
 }
 
 void IndexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
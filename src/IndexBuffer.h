@@ -1,16 +1,18 @@
 #pragma once
 
-class IndexBuffer // size is bytes and count as element count 
+#include "GLHandle.h"
+
+class IndexBuffer // size is bytes and count as element count, move only
 {
 private:
-    unsigned int m_RendererID;
+    BufferHandle m_RendererID;
     unsigned int m_Count;
 public:
     IndexBuffer(const unsigned int* data, unsigned int count);
-    ~IndexBuffer(); // Destructor
 
     void Bind() const;
     void Unbind() const;
 
     inline unsigned int GetCount() const { return m_Count; }
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
 };
\ No newline at end of file
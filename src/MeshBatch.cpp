@@ -0,0 +1,109 @@
+#include "MeshBatch.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <csignal>
+#include <numeric>
+
+MeshBatch::MeshBatch(BufferPool& pool, unsigned int stride, void (*addPage)(VertexArray&, const BufferPool&, unsigned int))
+    : m_Pool(pool), m_Stride(stride), m_AddPage(addPage), m_Alignment(std::lcm<std::size_t>(stride, sizeof(unsigned int))),
+      m_CommandBuffer(BufferHandle::Create()), m_DrawDataBuffer(BufferHandle::Create()), m_DrawDataSize(0),
+      m_MultiDraw(GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_draw_parameters)
+{
+}
+
+MeshBatch::MeshID MeshBatch::AddMesh(const float* vertices, std::size_t vertexCount,
+                                     const unsigned int* indices, std::size_t indexCount)
+{
+    std::size_t vertexSize = vertexCount * m_Stride;
+    std::size_t indexOffset = (vertexSize + sizeof(unsigned int) - 1) / sizeof(unsigned int) * sizeof(unsigned int);
+
+    // nothing to draw, nothing allocated. the id is still valid, Draw skips it
+    Mesh mesh;
+    mesh.allocation = indexCount != 0
+        ? m_Pool.Allocate(indexOffset + indexCount * sizeof(unsigned int), m_Alignment) : BufferPool::kInvalid;
+    mesh.indexOffset = indexOffset;
+    mesh.indexCount = mesh.allocation != BufferPool::kInvalid ? (unsigned int)indexCount : 0;
+    if (mesh.allocation != BufferPool::kInvalid)
+    {
+        m_Pool.Upload(mesh.allocation, vertices, vertexSize);
+        m_Pool.Upload(mesh.allocation, indices, indexCount * sizeof(unsigned int), indexOffset);
+
+        // first mesh on this page, it gets its vertex array
+        unsigned int page = m_Pool.Get(mesh.allocation).page;
+        if (page >= m_VertexArrays.size())
+            m_VertexArrays.resize(page + 1);
+        if (!m_VertexArrays[page])
+        {
+            m_VertexArrays[page] = std::make_unique<VertexArray>();
+            m_AddPage(*m_VertexArrays[page], m_Pool, page);
+        }
+    }
+    m_Meshes.push_back(mesh);
+    return (MeshID)(m_Meshes.size() - 1);
+}
+
+void MeshBatch::RemoveMesh(MeshID mesh)
+{
+    if (mesh >= m_Meshes.size() || m_Meshes[mesh].allocation == BufferPool::kInvalid)
+        return;
+    m_Pool.Free(m_Meshes[mesh].allocation);
+    m_Meshes[mesh].allocation = BufferPool::kInvalid;
+    m_Meshes[mesh].indexCount = 0;
+}
+
+void MeshBatch::BeginFrame()
+{
+    m_Commands.clear();
+    m_CommandPages.clear();
+    m_PageRanges.clear();
+    m_DrawData.clear();
+}
+
+void MeshBatch::Upload()
+{
+    PROFILE_ZONE("MeshBatch::Upload");
+    m_PageRanges.clear();
+    if (m_Commands.empty())
+        return;
+
+    // by page, so each page is one vertex array bind and one multi draw. the base
+    // instance still points every command at its own draw data
+    if (!std::is_sorted(m_CommandPages.begin(), m_CommandPages.end()))
+    {
+        std::vector<unsigned int> order(m_Commands.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+        {
+            return m_CommandPages[a] < m_CommandPages[b];
+        });
+        std::vector<DrawElementsIndirectCommand> commands(m_Commands.size());
+        std::vector<unsigned int> pages(m_Commands.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            commands[i] = m_Commands[order[i]];
+            pages[i] = m_CommandPages[order[i]];
+        }
+        m_Commands.swap(commands);
+        m_CommandPages.swap(pages);
+    }
+    for (unsigned int i = 0; i < m_Commands.size(); i++)
+    {
+        if (i == 0 || m_CommandPages[i] != m_CommandPages[i - 1])
+            m_PageRanges.push_back({ m_VertexArrays[m_CommandPages[i]].get(), i, 0 });
+        m_PageRanges.back().count++;
+    }
+
+    // orphaned every frame, the driver hands out fresh storage instead of waiting on last frame's draws
+    GLStateCache& state = GLStateCache::Get();
+    if (m_MultiDraw)
+    {
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer.Get());
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(DrawElementsIndirectCommand),
+                            m_Commands.data(), GL_STREAM_DRAW));
+    }
+    state.BindBuffer(GL_SHADER_STORAGE_BUFFER, m_DrawDataBuffer.Get());
+    GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, m_DrawData.size(), m_DrawData.data(), GL_STREAM_DRAW));
+}
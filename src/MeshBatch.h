@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "BufferPool.h"
+#include "UniformBuffer.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+
+// the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "indirect commands are 5 tightly packed ints");
+
+// Many meshes sub-allocated from a BufferPool, drawn with one glMultiDrawElementsIndirect
+// per pool page (Renderer::DrawBatch), so usually one. A mesh's vertices and indices
+// share an allocation and every page has a single vertex array, meshes can come and
+// go at any time. Every draw of a frame brings a block of per-draw data, which the
+// shader reads from a std430 storage buffer at [gl_BaseInstanceARB] (see
+// res/shaders/gallery.shader). Needs GL 4.3 for the storage buffer; without
+// ARB_multi_draw_indirect or ARB_shader_draw_parameters the same commands are
+// issued one by one with the index in the u_DrawID uniform.
+class MeshBatch
+{
+public:
+    using MeshID = unsigned int;
+
+    // the commands of one pool page, drawn with its vertex array
+    struct PageRange
+    {
+        const VertexArray* vertexArray;
+        unsigned int first;
+        unsigned int count;
+    };
+
+private:
+    struct Mesh
+    {
+        BufferPool::Handle allocation; // vertices, then the indices at indexOffset. kInvalid when empty or removed
+        std::size_t indexOffset;
+        unsigned int indexCount;       // 0 when empty or removed
+    };
+
+    BufferPool& m_Pool;
+    unsigned int m_Stride;
+    void (*m_AddPage)(VertexArray&, const BufferPool&, unsigned int); // AddBuffer with the vertex type
+    std::size_t m_Alignment;         // of an allocation: the vertex stride, and 4 for the indices
+    std::vector<Mesh> m_Meshes;
+    std::vector<std::unique_ptr<VertexArray>> m_VertexArrays; // by pool page
+    BufferHandle m_CommandBuffer;
+    BufferHandle m_DrawDataBuffer;
+
+    std::vector<DrawElementsIndirectCommand> m_Commands; // this frame
+    std::vector<unsigned int> m_CommandPages;
+    std::vector<PageRange> m_PageRanges;                 // filled by Upload
+    std::vector<unsigned char> m_DrawData;
+    std::size_t m_DrawDataSize;                          // per draw, fixed by the first Draw
+    bool m_MultiDraw;
+
+public:
+    // every mesh's vertices are Vertex structs, read as Vertex::Layout
+    template <typename Vertex>
+    MeshBatch(BufferPool& pool, Vertex)
+        : MeshBatch(pool, sizeof(Vertex), [](VertexArray& va, const BufferPool& pool, unsigned int page)
+          {
+              va.AddBuffer<Vertex>(pool, page);
+          })
+    {
+    }
+    MeshBatch(BufferPool& pool, unsigned int stride, void (*addPage)(VertexArray&, const BufferPool&, unsigned int));
+
+    // uploaded right away. indices are relative to the mesh's own vertices
+    MeshID AddMesh(const float* vertices, std::size_t vertexCount, const unsigned int* indices, std::size_t indexCount);
+    // gives the space back to the pool, the id is not reused
+    void RemoveMesh(MeshID mesh);
+
+    void BeginFrame();
+
+    template <typename T>
+    void Draw(MeshID mesh, const T& drawData)
+    {
+        static_assert(std140::IsBlock<T>, "per draw data is read as std430, build it from the std140 types");
+        if (m_DrawDataSize == 0)
+            m_DrawDataSize = sizeof(T);
+        if (sizeof(T) != m_DrawDataSize || mesh >= m_Meshes.size() || m_Meshes[mesh].indexCount == 0)
+            return;
+
+        // read back every time, Defragment moves allocations
+        const Mesh& m = m_Meshes[mesh];
+        const BufferPool::Allocation& allocation = m_Pool.Get(m.allocation);
+        unsigned int firstIndex = (unsigned int)((allocation.offset + m.indexOffset) / sizeof(unsigned int));
+        int baseVertex = (int)(allocation.offset / m_Stride);
+        // the base instance is the draw's index into the draw data, it keeps counting across pages
+        unsigned int index = (unsigned int)m_Commands.size();
+        m_Commands.push_back({ m.indexCount, 1, firstIndex, baseVertex, index });
+        m_CommandPages.push_back(allocation.page);
+        std::size_t offset = m_DrawData.size();
+        m_DrawData.resize(offset + sizeof(T));
+        std::memcpy(m_DrawData.data() + offset, &drawData, sizeof(T));
+    }
+
+    // groups the frame's commands by page, then one upload for them and one for the per draw data
+    void Upload();
+
+    inline bool IsMultiDraw() const { return m_MultiDraw; }
+    inline const std::vector<PageRange>& GetPageRanges() const { return m_PageRanges; }
+    inline unsigned int GetCommandBuffer() const { return m_CommandBuffer.Get(); }
+    inline unsigned int GetDrawDataBuffer() const { return m_DrawDataBuffer.Get(); }
+    inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+    inline std::size_t GetMeshCount() const { return m_Meshes.size(); }
+};
@@ -0,0 +1,294 @@
+#include "MeshOptimizer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // Forsyth's scoring, with the constants from his write-up
+    constexpr unsigned int kCacheSize = kVertexCacheSize;
+    constexpr float kCacheDecayPower = 1.5f;
+    constexpr float kLastTriangleScore = 0.75f;  // the three vertices just used
+    constexpr float kValenceBoostScale = 2.0f;   // favours vertices with few triangles left
+    constexpr float kValenceBoostPower = 0.5f;
+    constexpr unsigned int kMaxValence = 64;     // table size, higher valences share the last entry
+    constexpr unsigned int kNone = ~0u;
+
+    struct ScoreTables
+    {
+        float cache[kCacheSize];
+        float valence[kMaxValence];
+
+        ScoreTables()
+        {
+            for (unsigned int i = 0; i < kCacheSize; i++)
+            {
+                if (i < 3)
+                    cache[i] = kLastTriangleScore;
+                else
+                    cache[i] = std::pow(1.0f - float(i - 3) / (kCacheSize - 3), kCacheDecayPower);
+            }
+            valence[0] = 0.0f;
+            for (unsigned int i = 1; i < kMaxValence; i++)
+                valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+        }
+
+        float VertexScore(int cachePosition, unsigned int activeTriangles) const
+        {
+            if (activeTriangles == 0)
+                return -1.0f; // nothing left to draw with it
+            float score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+            return score + valence[activeTriangles < kMaxValence ? activeTriangles : kMaxValence - 1];
+        }
+    };
+
+    // compares and hashes whole vertices of the array being welded by index
+    struct VertexKey
+    {
+        const float* vertices;
+        unsigned int stride;
+
+        std::size_t operator()(unsigned int index) const
+        {
+            // FNV-1a over the bytes, so -0.0 and 0.0 stay apart like memcmp sees them
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices + std::size_t(index) * stride);
+            std::size_t hash = 14695981039346656037ull;
+            for (std::size_t i = 0; i < stride * sizeof(float); i++)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            return hash;
+        }
+
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            return std::memcmp(vertices + std::size_t(a) * stride, vertices + std::size_t(b) * stride,
+                               stride * sizeof(float)) == 0;
+        }
+    };
+}
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, std::size_t indexCount, std::size_t vertexCount,
+                                    unsigned int cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0)
+        return stats;
+
+    // most recently used first, a hit or a miss moves the vertex to the front
+    std::vector<unsigned int> cache;
+    cache.reserve(cacheSize + 1);
+    std::size_t misses = 0;
+    for (std::size_t i = 0; i < indexCount; i++)
+    {
+        unsigned int vertex = indices[i];
+        auto found = std::find(cache.begin(), cache.end(), vertex);
+        if (found == cache.end())
+        {
+            misses++;
+            cache.insert(cache.begin(), vertex);
+            if (cache.size() > cacheSize)
+                cache.pop_back();
+        }
+        else
+            std::rotate(cache.begin(), found, found + 1);
+    }
+
+    stats.acmr = float(misses) / float(indexCount / 3);
+    stats.atvr = float(misses) / float(vertexCount);
+    return stats;
+}
+
+std::vector<unsigned int> WeldVertices(std::vector<float>& vertices, unsigned int stride)
+{
+    std::size_t vertexCount = vertices.size() / stride;
+    std::vector<unsigned int> indices(vertexCount);
+
+    // unique vertices are compacted towards the front as they are found. a lookup
+    // only ever reads positions that are either already compacted or not reached yet
+    VertexKey key = { vertices.data(), stride };
+    std::unordered_map<unsigned int, unsigned int, VertexKey, VertexKey> unique(vertexCount, key, key);
+    unsigned int count = 0;
+    for (std::size_t i = 0; i < vertexCount; i++)
+    {
+        auto found = unique.find((unsigned int)i);
+        if (found != unique.end())
+        {
+            indices[i] = found->second;
+            continue;
+        }
+        if (count != i)
+            std::memcpy(vertices.data() + std::size_t(count) * stride, vertices.data() + i * stride, stride * sizeof(float));
+        unique.emplace(count, count);
+        indices[i] = count++;
+    }
+
+    vertices.resize(std::size_t(count) * stride);
+    return indices;
+}
+
+void OptimizeVertexCache(unsigned int* indices, std::size_t indexCount, std::size_t vertexCount)
+{
+    static const ScoreTables tables;
+    std::size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // the triangles of every vertex, used ones are swapped out past active[vertex]
+    std::vector<unsigned int> active(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; i++)
+        active[indices[i]]++;
+    std::vector<std::size_t> first(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; v++)
+        first[v + 1] = first[v] + active[v];
+    std::vector<unsigned int> triangles(first[vertexCount]);
+    {
+        std::vector<std::size_t> cursor(first.begin(), first.end() - 1);
+        for (std::size_t i = 0; i < triangleCount * 3; i++)
+            triangles[cursor[indices[i]]++] = (unsigned int)(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = tables.VertexScore(-1, active[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    unsigned int best = 0;
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        const unsigned int* triangle = indices + t * 3;
+        triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = (unsigned int)t;
+    }
+
+    std::vector<unsigned int> output(triangleCount * 3);
+    unsigned int cache[kCacheSize + 3];
+    unsigned int cacheCount = 0;
+    std::size_t nextUnemitted = 0;
+    for (std::size_t out = 0; out < triangleCount; out++)
+    {
+        if (best == kNone)
+        {
+            // nothing left around the cache: carry on with the next triangle in input order
+            while (emitted[nextUnemitted])
+                nextUnemitted++;
+            best = (unsigned int)nextUnemitted;
+        }
+
+        const unsigned int* triangle = indices + std::size_t(best) * 3;
+        std::memcpy(output.data() + out * 3, triangle, 3 * sizeof(unsigned int));
+        emitted[best] = true;
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            unsigned int vertex = triangle[k];
+            unsigned int* list = triangles.data() + first[vertex];
+            unsigned int count = active[vertex];
+            for (unsigned int i = 0; i < count; i++)
+            {
+                if (list[i] == best)
+                {
+                    list[i] = list[count - 1];
+                    list[count - 1] = best;
+                    active[vertex]--;
+                    break;
+                }
+            }
+        }
+
+        // the triangle's vertices move to the front of the LRU, the rest shift back
+        unsigned int updated[kCacheSize + 3];
+        unsigned int updatedCount = 0;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            bool duplicate = false; // degenerate triangles
+            for (unsigned int i = 0; i < updatedCount; i++)
+                duplicate = duplicate || updated[i] == triangle[k];
+            if (!duplicate)
+                updated[updatedCount++] = triangle[k];
+        }
+        for (unsigned int i = 0; i < cacheCount; i++)
+        {
+            unsigned int vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                updated[updatedCount++] = vertex;
+        }
+
+        // rescore everything that moved, including what just fell out, and the
+        // triangles around it. the best of those goes next
+        best = kNone;
+        float bestScore = -1.0f;
+        for (unsigned int i = 0; i < updatedCount; i++)
+        {
+            unsigned int vertex = updated[i];
+            cachePosition[vertex] = i < kCacheSize ? (int)i : -1;
+            vertexScore[vertex] = tables.VertexScore(cachePosition[vertex], active[vertex]);
+        }
+        for (unsigned int i = 0; i < updatedCount; i++)
+        {
+            unsigned int vertex = updated[i];
+            const unsigned int* list = triangles.data() + first[vertex];
+            for (unsigned int j = 0; j < active[vertex]; j++)
+            {
+                unsigned int t = list[j];
+                const unsigned int* other = indices + std::size_t(t) * 3;
+                triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = updatedCount < kCacheSize ? updatedCount : kCacheSize;
+        std::memcpy(cache, updated, cacheCount * sizeof(unsigned int));
+    }
+
+    std::memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+}
+
+void OptimizeVertexFetch(std::vector<float>& vertices, unsigned int stride, std::vector<unsigned int>& indices)
+{
+    std::size_t vertexCount = vertices.size() / stride;
+    std::vector<unsigned int> remap(vertexCount, kNone);
+    std::vector<float> ordered;
+    ordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices)
+    {
+        if (remap[index] == kNone)
+        {
+            remap[index] = (unsigned int)(ordered.size() / stride);
+            ordered.insert(ordered.end(), vertices.begin() + std::size_t(index) * stride,
+                           vertices.begin() + (std::size_t(index) + 1) * stride);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+MeshOptimizeReport OptimizeMesh(std::vector<float>& vertices, unsigned int stride, std::vector<unsigned int>& indices)
+{
+    PROFILE_ZONE("OptimizeMesh");
+    MeshOptimizeReport report;
+    report.inputVertices = vertices.size() / stride;
+
+    indices = WeldVertices(vertices, stride);
+    report.weldedVertices = vertices.size() / stride;
+    report.before = AnalyzeVertexCache(indices.data(), indices.size(), report.weldedVertices);
+
+    // recursive generators often emit close to cache order already (sierpinski's
+    // ~1.53 beats the reordering's ~1.62), keep theirs unless the reordering wins
+    std::vector<unsigned int> generatorOrder = indices;
+    OptimizeVertexCache(indices.data(), indices.size(), report.weldedVertices);
+    if (AnalyzeVertexCache(indices.data(), indices.size(), report.weldedVertices).acmr > report.before.acmr)
+        indices.swap(generatorOrder);
+    OptimizeVertexFetch(vertices, stride, indices);
+    report.after = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size() / stride);
+    return report;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Post-processing for the generators' triangle lists before they go into an
+// IndexBuffer: weld the soup into indexed geometry, reorder the triangles so the
+// post-transform vertex cache hits as often as possible (Forsyth's linear-speed
+// algorithm) and reorder the vertices into first-use order for fetch locality.
+
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // vertex shader runs per triangle: 3 without any reuse, 0.5 is the ideal for a large grid
+    float atvr = 0.0f; // vertex shader runs per vertex: 1 is the ideal
+};
+
+struct MeshOptimizeReport
+{
+    std::size_t inputVertices = 0;
+    std::size_t weldedVertices = 0;
+    VertexCacheStats before; // welded, generator order
+    VertexCacheStats after;
+};
+
+// entries of the modelled post-transform cache, an LRU. OptimizeVertexCache scores for
+// it and AnalyzeVertexCache measures it, so the report is about what was optimized
+constexpr unsigned int kVertexCacheSize = 32;
+
+// simulates the LRU post-transform cache with cacheSize entries
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, std::size_t indexCount, std::size_t vertexCount,
+                                    unsigned int cacheSize = kVertexCacheSize);
+
+// merges bitwise identical vertices (stride floats each), compacting the vertices in
+// place. returns the index list that rebuilds the original triangle list from them
+std::vector<unsigned int> WeldVertices(std::vector<float>& vertices, unsigned int stride);
+
+// reorders the triangles in place, vertices stay where they are
+void OptimizeVertexCache(unsigned int* indices, std::size_t indexCount, std::size_t vertexCount);
+
+// puts the vertices in the order the indices first use them and remaps the
+// indices, unreferenced vertices are dropped
+void OptimizeVertexFetch(std::vector<float>& vertices, unsigned int stride, std::vector<unsigned int>& indices);
+
+// all of the above on a triangle list straight from a generator
+MeshOptimizeReport OptimizeMesh(std::vector<float>& vertices, unsigned int stride, std::vector<unsigned int>& indices);
@@ -0,0 +1,192 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        std::int64_t begin; // ns since Init
+        std::int64_t end;   // < 0 for a frame marker
+    };
+
+    // filled by its thread only. count is published with release, so Shutdown on
+    // another thread reads only finished events. full chunks get a successor and
+    // are never touched again
+    struct Chunk
+    {
+        static constexpr unsigned int kCapacity = 8192;
+
+        Event events[kCapacity];
+        std::atomic<unsigned int> count{ 0 };
+        std::atomic<Chunk*> next{ nullptr };
+    };
+
+    struct ThreadBuffer
+    {
+        unsigned int id;
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<Chunk*> head{ nullptr }; // allocated with the first event
+        Chunk* tail = nullptr;               // owning thread only
+
+        explicit ThreadBuffer(unsigned int id) : id(id) {}
+        ~ThreadBuffer()
+        {
+            for (Chunk* chunk = head.load(std::memory_order_relaxed); chunk;)
+            {
+                Chunk* next = chunk->next.load(std::memory_order_relaxed);
+                delete chunk;
+                chunk = next;
+            }
+        }
+
+        void Push(const Event& event)
+        {
+            if (!tail)
+            {
+                tail = new Chunk();
+                head.store(tail, std::memory_order_release);
+            }
+            unsigned int count = tail->count.load(std::memory_order_relaxed);
+            if (count == Chunk::kCapacity)
+            {
+                Chunk* chunk = new Chunk();
+                tail->next.store(chunk, std::memory_order_release);
+                tail = chunk;
+                count = 0;
+            }
+            tail->events[count] = event;
+            tail->count.store(count + 1, std::memory_order_release);
+        }
+    };
+
+    // a thread takes the lock once, the first time it records. buffers live until
+    // exit, a thread that has finished still shows up in the trace
+    std::mutex s_RegistryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+    thread_local ThreadBuffer* t_Buffer = nullptr;
+
+    std::string s_Path;
+    std::chrono::steady_clock::time_point s_Epoch;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (!t_Buffer)
+        {
+            std::lock_guard<std::mutex> lock(s_RegistryMutex);
+            s_Buffers.push_back(std::make_unique<ThreadBuffer>((unsigned int)s_Buffers.size()));
+            t_Buffer = s_Buffers.back().get();
+        }
+        return *t_Buffer;
+    }
+
+    void WriteString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (; *text; text++)
+        {
+            if (*text == '"' || *text == '\\')
+                out << '\\';
+            out << *text;
+        }
+        out << '"';
+    }
+}
+
+void Profiler::Init()
+{
+    const char* path = std::getenv("MATH_ENGINE_TRACE");
+    if (!path || !*path)
+        return;
+    s_Path = path;
+    s_Epoch = std::chrono::steady_clock::now();
+    s_Enabled.store(true, std::memory_order_release);
+    SetThreadName("main");
+}
+
+std::int64_t Profiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+}
+
+void Profiler::Record(const char* name, std::int64_t begin, std::int64_t end)
+{
+    GetThreadBuffer().Push({ name, begin, end });
+}
+
+void Profiler::Frame()
+{
+    if (IsEnabled())
+        GetThreadBuffer().Push({ "frame", Now(), -1 });
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    if (!IsEnabled())
+        return; // no buffer for threads of a run that isn't traced
+    GetThreadBuffer().name.store(name, std::memory_order_relaxed);
+}
+
+void Profiler::Shutdown()
+{
+    if (!IsEnabled())
+        return;
+    // zones that close from now on record nothing. one racing this on another
+    // thread may still land in its buffer, it just isn't written out
+    s_Enabled.store(false, std::memory_order_relaxed);
+
+    std::ofstream out(s_Path);
+    if (!out)
+    {
+        std::cout << "Could not write the trace to " << s_Path << std::endl;
+        return;
+    }
+
+    // microseconds, which is what the format wants
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::size_t events = 0;
+    bool first = true;
+    std::lock_guard<std::mutex> lock(s_RegistryMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : s_Buffers)
+    {
+        if (const char* name = buffer->name.load(std::memory_order_relaxed))
+        {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"args\":{\"name\":";
+            WriteString(out, name);
+            out << "}}";
+            first = false;
+        }
+
+        const Chunk* chunk = buffer->head.load(std::memory_order_acquire);
+        for (; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            unsigned int count = chunk->count.load(std::memory_order_acquire);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                const Event& event = chunk->events[i];
+                out << (first ? "" : ",\n") << "{\"name\":";
+                WriteString(out, event.name);
+                if (event.end < 0)
+                    out << ",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << event.begin / 1000.0;
+                else
+                    out << ",\"ph\":\"X\",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0;
+                out << ",\"pid\":1,\"tid\":" << buffer->id << "}";
+                first = false;
+                events++;
+            }
+        }
+    }
+    out << "\n]}\n";
+    std::cout << "Trace: " << events << " events from " << s_Buffers.size() << " thread(s) written to " << s_Path << std::endl;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// CPU timeline of named zones, written as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev) to attach to performance reports.
+//
+//     MATH_ENGINE_TRACE=trace.json ./window
+//
+// PROFILE_ZONE("name") times the rest of the enclosing block. Each thread records
+// into its own chunked buffer: recording is a couple of stores and an atomic
+// count, no lock and no allocation except once per few thousand events. The
+// file is written by Profiler::Shutdown. Without MATH_ENGINE_TRACE a zone is one
+// atomic load. Names are kept by pointer, use string literals.
+class Profiler
+{
+private:
+    static inline std::atomic<bool> s_Enabled{ false };
+
+public:
+    // reads MATH_ENGINE_TRACE, once at startup. the calling thread is named "main"
+    static void Init();
+    // writes the trace, if one was recorded. other threads may still be running
+    static void Shutdown();
+
+    static bool IsEnabled() { return s_Enabled.load(std::memory_order_acquire); }
+    // nanoseconds since Init
+    static std::int64_t Now();
+
+    // a vertical line across every thread, once per frame from the render loop
+    static void Frame();
+    // shown in the viewer instead of the thread number. ignored when not tracing
+    static void SetThreadName(const char* name);
+
+    // a finished zone, see ProfileZone
+    static void Record(const char* name, std::int64_t begin, std::int64_t end);
+};
+
+class ProfileZone
+{
+private:
+    const char* m_Name; // nullptr when not recording
+    std::int64_t m_Begin;
+
+public:
+    explicit ProfileZone(const char* name)
+        : m_Name(Profiler::IsEnabled() ? name : nullptr), m_Begin(m_Name ? Profiler::Now() : 0) {}
+    ~ProfileZone()
+    {
+        // checked again, a zone still open at Shutdown would record into a trace already written
+        if (m_Name && Profiler::IsEnabled())
+            Profiler::Record(m_Name, m_Begin, Profiler::Now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
@@ -0,0 +1,176 @@
+#include "ProgramCache.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const char kMagic[4] = {'M', 'E', 'P', 'B'};
+
+    struct BinaryHeader
+    {
+        char magic[4];
+        std::uint32_t format;
+        std::uint32_t length;
+    };
+
+    // FNV-1a, plenty for a cache key
+    std::uint64_t HashBytes(std::uint64_t hash, const char* data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string GetString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ProgramCache::ProgramCache(const std::string& directory)
+    : m_Directory(directory), m_Enabled(false)
+{
+    if (directory.empty() || directory == "0")
+        return;
+
+    GLint formats = 0;
+    if (GLEW_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0) // some drivers expose the entry points but no format
+        return;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "Shader cache disabled, can't create " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+
+    m_DriverID = GetString(GL_VENDOR) + '\n' + GetString(GL_RENDERER) + '\n' + GetString(GL_VERSION);
+    m_Enabled = true;
+}
+
+ProgramCache& ProgramCache::Get()
+{
+    static ProgramCache cache([]()
+    {
+        const char* directory = std::getenv("MATH_ENGINE_SHADER_CACHE");
+        return std::string(directory ? directory : "./.shader_cache");
+    }());
+    return cache;
+}
+
+std::uint64_t ProgramCache::Hash(const ShaderProgramSource& source) const
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    hash = HashBytes(hash, source.VertexSource.data(), source.VertexSource.size() + 1); // include the '\0' as separator
+    hash = HashBytes(hash, source.FragmentSource.data(), source.FragmentSource.size() + 1);
+    hash = HashBytes(hash, m_DriverID.data(), m_DriverID.size());
+    return hash;
+}
+
+std::string ProgramCache::GetPath(std::uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return m_Directory + "/" + name;
+}
+
+unsigned int ProgramCache::Load(std::uint64_t key) const
+{
+    PROFILE_ZONE("ProgramCache::Load");
+    if (!m_Enabled)
+        return 0;
+
+    std::string path = GetPath(key);
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return 0;
+
+    BinaryHeader header;
+    std::vector<char> binary;
+    if (stream.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        std::equal(kMagic, kMagic + 4, header.magic))
+    {
+        // the length comes from disk, it has to match what is actually left in
+        // the file before anything is allocated for it
+        std::streampos start = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        std::streamoff remaining = stream.tellg() - start;
+        stream.seekg(start);
+        if (stream && remaining == std::streamoff(header.length))
+        {
+            binary.resize(header.length);
+            stream.read(binary.data(), binary.size());
+        }
+    }
+    if (binary.empty() || !stream)
+    {
+        std::remove(path.c_str()); // truncated or foreign file
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+    int linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        // the driver is allowed to reject any blob, compile from source and overwrite it
+        glDeleteProgram(program);
+        std::remove(path.c_str());
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::Store(std::uint64_t key, unsigned int program) const
+{
+    PROFILE_ZONE("ProgramCache::Store");
+    if (!m_Enabled || program == 0)
+        return;
+
+    int linked = GL_FALSE, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked == GL_FALSE || length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    BinaryHeader header;
+    std::copy(kMagic, kMagic + 4, header.magic);
+    header.format = format;
+    header.length = (std::uint32_t)length;
+
+    // written next to the entry and renamed, so a crash never leaves half a blob behind
+    std::string path = GetPath(key);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(binary.data(), length);
+        if (!stream)
+        {
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Shader.h"
+
+// Keeps linked programs on disk (glGetProgramBinary) so later starts can skip
+// the GLSL compile. Entries are keyed by the shader source and the driver's
+// vendor/renderer/version strings, so a driver update simply misses.
+class ProgramCache
+{
+private:
+    std::string m_Directory;
+    std::string m_DriverID;
+    bool m_Enabled;
+
+public:
+    explicit ProgramCache(const std::string& directory);
+
+    // ./.shader_cache, or $MATH_ENGINE_SHADER_CACHE ("0" turns caching off).
+    // needs a current context the first time it's used
+    static ProgramCache& Get();
+
+    inline bool IsEnabled() const { return m_Enabled; }
+
+    std::uint64_t Hash(const ShaderProgramSource& source) const;
+
+    // a linked program, or 0 on a miss or when the driver rejects the blob
+    unsigned int Load(std::uint64_t key) const;
+    // the program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void Store(std::uint64_t key, unsigned int program) const;
+
+private:
+    std::string GetPath(std::uint64_t key) const;
+};
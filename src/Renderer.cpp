@@ -1,19 +1,161 @@
 #include "Renderer.h"
+#include "IndexBuffer.h"
+#include "GLStateCache.h"
+#include "MeshBatch.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "VertexArray.h"
 
-#include <iostream>
+#include <algorithm>
+#include <csignal>
 
-void GLClearError()
+Renderer::Renderer(const UniformRingBuffer* uniforms, unsigned int uniformBinding)
+    : m_Uniforms(uniforms), m_UniformBinding(uniformBinding), m_Layer(0)
 {
-    while (glGetError() != GL_NO_ERROR);
 }
 
-bool GLLogCall(const char* function, const char* file, int line) 
+void Renderer::Clear() const
 {
-    while (GLenum error = glGetError())
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::BeginFrame()
+{
+    m_Commands.clear(); // keeps the capacity, no allocations once the scene has settled
+    m_Layer = 0;
+}
+
+std::uint64_t Renderer::MakeKey(const Shader& shader, const VertexArray& va, const IndexBuffer* ib, unsigned int mode) const
+{
+    // the layer on top so paint order between layers always holds, then the most
+    // expensive switch. ids past the field width only cost some sorting quality,
+    // merging compares the real objects
+    std::uint64_t layer = m_Layer & 0xFF;
+    std::uint64_t program = shader.GetRendererID() & 0xFFFF;
+    std::uint64_t vertexArray = va.GetRendererID() & 0xFFFF;
+    std::uint64_t indexBuffer = (ib ? ib->GetRendererID() : 0) & 0xFFFFF;
+    return layer << 56 | program << 40 | vertexArray << 24 | indexBuffer << 4 | (mode & 0xF);
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader,
+                      UniformAllocation uniforms, unsigned int mode, unsigned int first, unsigned int count)
+{
+    if (count == ~0u)
+        count = ib.GetCount() - first;
+    m_Commands.push_back({ MakeKey(shader, va, &ib, mode), &shader, &va, &ib, mode, first, count, uniforms });
+}
+
+void Renderer::SubmitArrays(const VertexArray& va, unsigned int first, unsigned int count, Shader& shader,
+                            UniformAllocation uniforms, unsigned int mode)
+{
+    m_Commands.push_back({ MakeKey(shader, va, nullptr, mode), &shader, &va, nullptr, mode, first, count, uniforms });
+}
+
+bool Renderer::CanMerge(const DrawCommand& a, const DrawCommand& b)
+{
+    // same state and b picks up exactly where a ends. lists and strips don't concatenate.
+    // the uniforms have to be the very same allocation, one draw can only bind one
+    bool list = a.mode == GL_TRIANGLES || a.mode == GL_LINES || a.mode == GL_POINTS;
+    return list && a.shader == b.shader && a.va == b.va && a.ib == b.ib && a.mode == b.mode
+        && a.first + a.count == b.first
+        && a.uniforms.offset == b.uniforms.offset && a.uniforms.size == b.uniforms.size;
+}
+
+void Renderer::Flush()
+{
+    PROFILE_ZONE("Renderer::Flush");
+    GLDebugGroup group("Renderer::Flush");
+    m_Stats = Stats();
+    m_Stats.submitted = (unsigned int)m_Commands.size();
+
+    // by key (layer first), then within equal state by range so contiguous pieces
+    // end up next to each other and merge. only draws equal in both keep their
+    // submission order, paint order is what the layers guarantee
+    std::stable_sort(m_Commands.begin(), m_Commands.end(), [](const DrawCommand& a, const DrawCommand& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.first < b.first;
+    });
+
+    const Shader* program = nullptr;
+    const VertexArray* vertexArray = nullptr;
+    for (std::size_t i = 0; i < m_Commands.size(); )
+    {
+        DrawCommand draw = m_Commands[i++];
+        while (i < m_Commands.size() && CanMerge(draw, m_Commands[i]))
+            draw.count += m_Commands[i++].count;
+
+        if (!draw.shader->IsReady())
+            continue;
+
+        if (draw.shader != program)
+        {
+            draw.shader->Bind();
+            program = draw.shader;
+            m_Stats.programs++;
+        }
+        if (draw.va != vertexArray)
+        {
+            draw.va->Bind();
+            vertexArray = draw.va;
+            m_Stats.vertexArrays++;
+        }
+        if (m_Uniforms && draw.uniforms.size != 0)
+            m_Uniforms->Bind(m_UniformBinding, draw.uniforms);
+
+        if (draw.ib)
+        {
+            draw.ib->Bind();
+            GLCall(glDrawElements(draw.mode, draw.count, GL_UNSIGNED_INT,
+                                  reinterpret_cast<const void*>(draw.first * sizeof(unsigned int))));
+        }
+        else
+        {
+            GLCall(glDrawArrays(draw.mode, draw.first, draw.count));
+        }
+        m_Stats.draws++;
+    }
+    m_Commands.clear();
+}
+
+void Renderer::DrawBatch(MeshBatch& batch, Shader& shader, unsigned int drawDataBinding)
+{
+    if (!shader.IsReady())
+        return;
+    PROFILE_ZONE("Renderer::DrawBatch");
+    GLDebugGroup group("Renderer::DrawBatch");
+    batch.Upload();
+    const std::vector<DrawElementsIndirectCommand>& commands = batch.GetCommands();
+    if (commands.empty())
+        return;
+
+    shader.Bind();
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, batch.GetDrawDataBuffer()));
+    if (batch.IsMultiDraw())
+        GLStateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.GetCommandBuffer());
+
+    for (const MeshBatch::PageRange& range : batch.GetPageRanges())
     {
-        std::cout<< "[OpenGL Error] (" << error << ") " << function << " "
-        << file << " " << line << std::endl;
-        return false;
+        range.vertexArray->Bind();
+        if (batch.IsMultiDraw())
+        {
+            GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                               reinterpret_cast<const void*>(range.first * sizeof(DrawElementsIndirectCommand)),
+                                               (GLsizei)range.count, 0));
+            m_Stats.draws++;
+            continue;
+        }
+
+        // same commands one at a time. the base instance still goes along, a shader with
+        // draw parameters but no multi draw reads it; without them it reads u_DrawID
+        for (unsigned int i = range.first; i < range.first + range.count; i++)
+        {
+            const DrawElementsIndirectCommand& command = commands[i];
+            if (!GLEW_ARB_shader_draw_parameters)
+                shader.SetUniform1i("u_DrawID", command.baseInstance);
+            GLCall(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                                                                 reinterpret_cast<const void*>(command.firstIndex * sizeof(unsigned int)),
+                                                                 1, command.baseVertex, command.baseInstance));
+            m_Stats.draws++;
+        }
     }
-    return true;
-}
\ No newline at end of file
+}
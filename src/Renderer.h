@@ -1,11 +1,85 @@
+#pragma once
+
 #include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+#include "GLDebug.h"
+#include "UniformBuffer.h"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class MeshBatch;
+
+struct DrawCommand
+{
+    std::uint64_t key;            // layer | program | vertex array | index buffer | mode, see MakeKey
+    Shader* shader;
+    const VertexArray* va;
+    const IndexBuffer* ib;        // nullptr draws arrays
+    unsigned int mode;            // GL_TRIANGLES, GL_LINES, ...
+    unsigned int first;           // first index or vertex
+    unsigned int count;           // indices or vertices
+    UniformAllocation uniforms;   // size 0 when the draw has no block of its own
+};
+
+// Collects the frame's draws, then sorts them by state so program and vertex array
+// switches happen as rarely as possible, merges neighbours that differ only in a
+// contiguous range and submits everything in one pass. Binds go through
+// GLStateCache, so whatever stays the same between two draws isn't re-bound.
+// Sorting changes paint order, and nothing here is depth tested: draws that overlap
+// go in different layers (SetLayer), lower layers are drawn first. Within a layer
+// the order is by state.
+class Renderer
+{
+public:
+    struct Stats
+    {
+        unsigned int submitted = 0;    // Submit calls
+        unsigned int draws = 0;        // draw calls after merging
+        unsigned int programs = 0;     // program switches
+        unsigned int vertexArrays = 0; // vertex array switches
+    };
+
+private:
+    std::vector<DrawCommand> m_Commands;
+    const UniformRingBuffer* m_Uniforms; // where DrawCommand::uniforms live
+    unsigned int m_UniformBinding;
+    unsigned int m_Layer;
+    Stats m_Stats;
+
+    std::uint64_t MakeKey(const Shader& shader, const VertexArray& va, const IndexBuffer* ib, unsigned int mode) const;
+    static bool CanMerge(const DrawCommand& a, const DrawCommand& b);
+
+public:
+    // per draw uniform blocks are bound from uniforms at uniformBinding
+    explicit Renderer(const UniformRingBuffer* uniforms = nullptr, unsigned int uniformBinding = 0);
+
+    void Clear() const;
+
+    // drops anything still queued, back to layer 0
+    void BeginFrame();
+
+    // draws submitted from now on are painted after those of lower layers, 0..255
+    inline void SetLayer(unsigned int layer) { m_Layer = layer < 255 ? layer : 255; }
 
-#define ASSERT(x) if (!(x)) raise(SIGTRAP); // macro
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+    // indexed, count indices from first (whole buffer by default). neighbouring ranges
+    // only merge into one draw if they share the uniform allocation too, a draw that
+    // pushed its own block keeps its own draw call
+    void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader,
+                UniformAllocation uniforms = { 0, 0 }, unsigned int mode = GL_TRIANGLES,
+                unsigned int first = 0, unsigned int count = ~0u);
+    // non indexed
+    void SubmitArrays(const VertexArray& va, unsigned int first, unsigned int count, Shader& shader,
+                      UniformAllocation uniforms = { 0, 0 }, unsigned int mode = GL_TRIANGLES);
 
+    // sorts, merges and draws the queue; the uniform ring has to be uploaded by now
+    void Flush();
 
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+    // every draw of the batch right away, one glMultiDrawElementsIndirect per pool page.
+    // the per draw data goes to the storage buffer binding drawDataBinding (see MeshBatch.h)
+    void DrawBatch(MeshBatch& batch, Shader& shader, unsigned int drawDataBinding);
 
+    inline const Stats& GetStats() const { return m_Stats; } // of the last Flush
+};
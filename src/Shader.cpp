@@ -1 +1,319 @@
-#include "Shader.h"
\ No newline at end of file
+#include "Shader.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "ProgramCache.h"
+#include "Profiler.h"
+#include "ShaderCompileQueue.h"
+#include "ShaderParser.h"
+#include "SpirvModule.h"
+
+#include <csignal>
+#include <iostream>
+
+Shader::Shader(const std::string& filepath)
+    : Shader(filepath, {}, nullptr)
+{
+}
+
+Shader::Shader(const std::string& filepath, ShaderCompileQueue& queue)
+    : Shader(filepath, {}, &queue)
+{
+}
+
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines, ShaderCompileQueue* queue)
+    : m_FilePath(filepath), m_Defines(defines), m_Queue(nullptr)
+{
+    PROFILE_ZONE("Shader load");
+    // SPIR-V skips the GLSL front end altogether, the source is only parsed without it
+    if (SpirvModule::IsEnabled() && LoadSpirv())
+        return;
+
+    ShaderProgramSource source = ShaderParser::ApplyDefines(ShaderParser::Parse(filepath), m_Defines);
+
+    // a cached binary skips compile and link entirely, otherwise build it and save it for next time
+    ProgramCache& cache = ProgramCache::Get();
+    std::uint64_t key = cache.Hash(source);
+    m_RendererID.Reset(cache.Load(key));
+    if (m_RendererID)
+        return;
+
+    if (queue)
+    {
+        m_Queue = queue;
+        queue->Submit(*this, source, key);
+    }
+    else
+    {
+        m_RendererID.Reset(CreateShader(source.VertexSource, source.FragmentSource));
+        cache.Store(key, m_RendererID.Get()); // skips 0
+    }
+}
+
+Shader::~Shader()
+{
+    if (m_Queue)
+        m_Queue->Cancel(*this);
+}
+
+bool Shader::CheckCompile(unsigned int id, unsigned int type)
+{
+    // Error Handling
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        int length;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+        char *message = (char *)alloca(length * sizeof(char)); // allocate on stack here instead of heap
+        glGetShaderInfoLog(id, length, &length, message);
+        std::cout << "Failed to compile "
+                  << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                  << " shader! (" << m_FilePath << ")" << std::endl;
+        std::cout << message << std::endl;
+        return false;
+    }
+    return true;
+}
+
+unsigned int Shader::StartProgram(const std::string& vertexShader, const std::string& fragmentShader,
+                                  unsigned int& vs, unsigned int& fs)
+{
+    PROFILE_ZONE("Shader compile"); // only the submission when the driver compiles in parallel
+    unsigned int program = glCreateProgram();
+    vs = glCreateShader(GL_VERTEX_SHADER);
+    fs = glCreateShader(GL_FRAGMENT_SHADER);
+
+    const char *src = vertexShader.c_str();
+    glShaderSource(vs, 1, &src, nullptr);
+    glCompileShader(vs);
+
+    src = fragmentShader.c_str();
+    glShaderSource(fs, 1, &src, nullptr);
+    glCompileShader(fs);
+
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    if (ProgramCache::Get().IsEnabled())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+
+    return program;
+}
+
+bool Shader::FinishProgram(unsigned int program, unsigned int vs, unsigned int fs)
+{
+    PROFILE_ZONE("Shader link");
+    bool compiled = CheckCompile(vs, GL_VERTEX_SHADER);
+    compiled = CheckCompile(fs, GL_FRAGMENT_SHADER) && compiled;
+
+    int result;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (compiled && result == GL_FALSE)
+    {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        char *message = (char *)alloca(length * sizeof(char));
+        glGetProgramInfoLog(program, length, &length, message);
+        std::cout << "Failed to link shader! (" << m_FilePath << ")" << std::endl;
+        std::cout << message << std::endl;
+    }
+    glValidateProgram(program);
+
+    glDetachShader(program, vs);
+    glDetachShader(program, fs);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    return compiled && result == GL_TRUE;
+}
+
+unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+{
+    unsigned int vs, fs;
+    unsigned int program = StartProgram(vertexShader, fragmentShader, vs, fs);
+    if (!FinishProgram(program, vs, fs))
+    {
+        glDeleteProgram(program);
+        return 0; // not ready, callers fall back to something else
+    }
+    return program;
+}
+
+static unsigned int CreateSpirvStage(unsigned int type, const std::vector<char>& binary,
+                                     const std::vector<unsigned int>& ids, const std::vector<unsigned int>& values)
+{
+    unsigned int id = glCreateShader(type);
+    glShaderBinary(1, &id, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, binary.data(), (GLsizei)binary.size());
+    glSpecializeShaderARB(id, "main", (GLuint)ids.size(), ids.data(), values.data());
+    return id;
+}
+
+bool Shader::LoadSpirv()
+{
+    PROFILE_ZONE("Shader::LoadSpirv");
+    SpirvModule module;
+    if (!module.Load(m_FilePath))
+        return false;
+
+    std::vector<unsigned int> ids, values;
+    if (!module.GetSpecialization(m_Defines, ids, values))
+    {
+        std::cout << "Defines of " << m_FilePath << " aren't all #variants keys, compiling GLSL instead of SPIR-V" << std::endl;
+        return false;
+    }
+
+    unsigned int program = glCreateProgram();
+    unsigned int vs = CreateSpirvStage(GL_VERTEX_SHADER, module.GetVertexBinary(), ids, values);
+    unsigned int fs = CreateSpirvStage(GL_FRAGMENT_SHADER, module.GetFragmentBinary(), ids, values);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    if (!FinishProgram(program, vs, fs))
+    {
+        std::cout << "Falling back to GLSL for " << m_FilePath << std::endl;
+        glDeleteProgram(program);
+        return false;
+    }
+
+    m_RendererID.Reset(program);
+    // no names in a SPIR-V program, the locations come from the manifest instead
+    m_UniformLocationCache = module.GetUniformLocations();
+    // and a block is the one still at the binding the script compiled in
+    int blockCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for (const auto& [name, compiledBinding] : module.GetBlockBindings())
+    {
+        for (int index = 0; index < blockCount; index++)
+        {
+            int binding = -1;
+            glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_BINDING, &binding);
+            if (binding == (int)compiledBinding)
+                m_UniformBlockIndexCache[name] = index;
+        }
+    }
+    return true;
+}
+
+bool Shader::Reload(const ShaderProgramSource& parsed)
+{
+    PROFILE_ZONE("Shader::Reload");
+    ShaderProgramSource source = ShaderParser::ApplyDefines(parsed, m_Defines);
+
+    if (m_Queue) // the old source is still compiling, this one supersedes it
+    {
+        m_Queue->Cancel(*this);
+        m_Queue = nullptr;
+    }
+
+    unsigned int vs, fs;
+    unsigned int program = StartProgram(source.VertexSource, source.FragmentSource, vs, fs);
+    if (!FinishProgram(program, vs, fs))
+    {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    ProgramCache& cache = ProgramCache::Get();
+    cache.Store(cache.Hash(source), program);
+
+    m_RendererID.Reset(program);
+    m_UniformLocationCache.clear(); // locations are per program
+    m_UniformBlockIndexCache.clear(); // GLSL from here on, blocks are found by name
+    ApplyUniformBlockBindings();
+    return true;
+}
+
+void Shader::Bind() const
+{
+    GLCall(GLStateCache::Get().UseProgram(m_RendererID.Get()));
+}
+
+void Shader::Unbind() const
+{
+    GLCall(GLStateCache::Get().UseProgram(0));
+}
+
+void Shader::SetUniform1i(const std::string& name, int value)
+{
+    GLCall(glUniform1i(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform1f(const std::string& name, float value)
+{
+    GLCall(glUniform1f(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+    GLCall(glUniform2f(GetUniformLocation(name), v0, v1));
+}
+
+void Shader::SetUniform3f(const std::string& name, float v0, float v1, float v2)
+{
+    GLCall(glUniform3f(GetUniformLocation(name), v0, v1, v2));
+}
+
+void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+{
+    GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+}
+
+void Shader::SetUniform2fv(const std::string& name, int count, const float* values)
+{
+    GLCall(glUniform2fv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniform4fv(const std::string& name, int count, const float* values)
+{
+    GLCall(glUniform4fv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniformMat3f(const std::string& name, const float* matrix)
+{
+    GLCall(glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, matrix));
+}
+
+void Shader::SetUniformMat4f(const std::string& name, const float* matrix)
+{
+    GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, matrix));
+}
+
+void Shader::SetUniformBlockBinding(const std::string& blockName, unsigned int binding)
+{
+    m_UniformBlockBindings[blockName] = binding;
+    if (m_RendererID)
+        ApplyUniformBlockBindings();
+}
+
+void Shader::ApplyUniformBlockBindings()
+{
+    for (const auto& [name, binding] : m_UniformBlockBindings)
+    {
+        auto cached = m_UniformBlockIndexCache.find(name);
+        unsigned int index = cached != m_UniformBlockIndexCache.end()
+            ? cached->second : glGetUniformBlockIndex(m_RendererID.Get(), name.c_str());
+        if (index == GL_INVALID_INDEX)
+        {
+            std::cout << "Warning: uniform block '" << name << "' doesn't exist (" << m_FilePath << ")" << std::endl;
+            continue;
+        }
+        GLCall(glUniformBlockBinding(m_RendererID.Get(), index, binding));
+    }
+}
+
+int Shader::GetUniformLocation(const std::string& name)
+{
+    if (!m_RendererID) // still compiling, nothing to cache yet
+        return -1;
+
+    auto cached = m_UniformLocationCache.find(name);
+    if (cached != m_UniformLocationCache.end())
+        return cached->second;
+
+    int location = glGetUniformLocation(m_RendererID.Get(), name.c_str());
+    if (location == -1)
+        std::cout << "Warning: uniform '" << name << "' doesn't exist (" << m_FilePath << ")" << std::endl;
+
+    m_UniformLocationCache[name] = location;
+    return location;
+}
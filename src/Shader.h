@@ -1,18 +1,90 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GLHandle.h"
+
+struct ShaderProgramSource
+{
+    std::string VertexSource;
+    std::string FragmentSource;
+    std::vector<std::string> VariantKeys; // from #variants, see ShaderParser
+};
+
+class ShaderCompileQueue;
+
 class Shader
 {
     private:
-    unsigned int m_RendererID;
-    //caching for uniforms
+    std::string m_FilePath;
+    std::vector<std::string> m_Defines; // enabled #variants keys or plain "#define KEY 1"s, see ShaderParser
+    ProgramHandle m_RendererID; // 0 while an async compile is still in flight or if it failed
+    ShaderCompileQueue* m_Queue;
+    //caching for uniforms, -1 is cached too so a missing uniform is only reported once
+    std::unordered_map<std::string, int> m_UniformLocationCache;
+    // block name -> binding point, reapplied to every program this shader gets
+    std::unordered_map<std::string, unsigned int> m_UniformBlockBindings;
+    // block name -> index, only for SPIR-V programs, which can't look a block up by name
+    std::unordered_map<std::string, unsigned int> m_UniformBlockIndexCache;
     public:
     Shader(const std::string& filepath);
+    // compile and link are only kicked off here, the queue hands the program over once
+    // the driver is done (see ShaderCompileQueue::Poll). until then, or for good if it
+    // fails to compile or link, IsReady() is false
+    Shader(const std::string& filepath, ShaderCompileQueue& queue);
+    // a permutation of the file, usually created through ShaderLibrary
+    Shader(const std::string& filepath, const std::vector<std::string>& defines, ShaderCompileQueue* queue = nullptr);
     ~Shader();
 
+    // not movable either, the compile queue and ShaderLibrary keep pointers to it
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
     void Bind() const;
-    void Unvind() const;
+    void Unbind() const;
+
+    inline bool IsReady() const { return (bool)m_RendererID; }
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
+    inline const std::string& GetFilePath() const { return m_FilePath; }
+    inline const std::vector<std::string>& GetDefines() const { return m_Defines; }
 
+    // Set uniforms, the program has to be bound
+    void SetUniform1i(const std::string& name, int value);
+    void SetUniform1f(const std::string& name, float value);
+    void SetUniform2f(const std::string& name, float v0, float v1);
+    void SetUniform3f(const std::string& name, float v0, float v1, float v2);
     void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+    void SetUniform2fv(const std::string& name, int count, const float* values);
+    void SetUniform4fv(const std::string& name, int count, const float* values);
+    void SetUniformMat3f(const std::string& name, const float* matrix); // column major, 9 floats
+    void SetUniformMat4f(const std::string& name, const float* matrix); // column major, 16 floats
+
+    // only the first call per name reaches the driver
+    int GetUniformLocation(const std::string& name);
+
+    // ties a uniform block to a binding point of UniformRingBuffer::Bind. kept across
+    // async compiles and reloads, so it can be called before the program is ready
+    void SetUniformBlockBinding(const std::string& blockName, unsigned int binding);
+
+    // builds a program from freshly parsed source (this shader's defines are added)
+    // and swaps it in, the current one is kept if that fails
+    bool Reload(const ShaderProgramSource& source);
     private:
-    unsigned int GetUniformLocation(const std::string& name);
-};
\ No newline at end of file
+    friend class ShaderCompileQueue;
+
+    unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+
+    // CreateShader in two halves: the first only issues the GL calls, the second
+    // queries the results (which waits for the driver) and releases the stages
+    unsigned int StartProgram(const std::string& vertexShader, const std::string& fragmentShader,
+                              unsigned int& vs, unsigned int& fs);
+    bool FinishProgram(unsigned int program, unsigned int vs, unsigned int fs);
+    bool CheckCompile(unsigned int id, unsigned int type);
+    void ApplyUniformBlockBindings();
+
+    // the offline compiled SPIR-V of the file specialized for m_Defines (SpirvModule.h),
+    // false if there is none or it fails and the GLSL has to be compiled instead
+    bool LoadSpirv();
+};
@@ -0,0 +1,93 @@
+#include "ShaderCompileQueue.h"
+#include "Renderer.h"
+#include "ProgramCache.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+ShaderCompileQueue::ShaderCompileQueue()
+    : m_Parallel(false)
+{
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // let the driver pick
+        m_Parallel = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        m_Parallel = true;
+    }
+}
+
+ShaderCompileQueue::~ShaderCompileQueue()
+{
+    // shaders that outlive the queue get their program now rather than never
+    Finish();
+}
+
+void ShaderCompileQueue::Submit(Shader& shader, const ShaderProgramSource& source, std::uint64_t cacheKey)
+{
+    Job job;
+    job.shader = &shader;
+    job.cacheKey = cacheKey;
+    job.program = shader.StartProgram(source.VertexSource, source.FragmentSource, job.vs, job.fs);
+    m_Jobs.push_back(job);
+}
+
+void ShaderCompileQueue::Cancel(Shader& shader)
+{
+    for (auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it)
+    {
+        if (it->shader == &shader)
+        {
+            glDeleteShader(it->vs);
+            glDeleteShader(it->fs);
+            glDeleteProgram(it->program);
+            m_Jobs.erase(it);
+            return;
+        }
+    }
+}
+
+void ShaderCompileQueue::Complete(Job& job)
+{
+    Shader& shader = *job.shader;
+    shader.m_Queue = nullptr;
+    // like the synchronous path a broken program is dropped, the shader stays not ready
+    if (!shader.FinishProgram(job.program, job.vs, job.fs))
+    {
+        glDeleteProgram(job.program);
+        return;
+    }
+    ProgramCache::Get().Store(job.cacheKey, job.program);
+    shader.m_RendererID.Reset(job.program);
+    shader.ApplyUniformBlockBindings();
+}
+
+unsigned int ShaderCompileQueue::Poll()
+{
+    PROFILE_ZONE("ShaderCompileQueue::Poll");
+    auto done = std::remove_if(m_Jobs.begin(), m_Jobs.end(), [this](Job& job)
+    {
+        if (m_Parallel)
+        {
+            int complete = GL_FALSE;
+            glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &complete);
+            if (complete == GL_FALSE)
+                return false;
+        }
+        Complete(job);
+        return true;
+    });
+    m_Jobs.erase(done, m_Jobs.end());
+    return GetPendingCount();
+}
+
+void ShaderCompileQueue::Finish()
+{
+    PROFILE_ZONE("ShaderCompileQueue::Finish");
+    for (Job& job : m_Jobs)
+        Complete(job);
+    m_Jobs.clear();
+}
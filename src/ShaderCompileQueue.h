@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Shader.h"
+
+// Lets every program be submitted up front and compiled concurrently by the
+// driver (GL_KHR_parallel_shader_compile), so startup waits for the slowest
+// program instead of the sum of all of them. Poll() never blocks when the
+// extension is there; without it a program is finished on the first Poll after
+// it was submitted, which still lets drivers that compile in the background overlap.
+class ShaderCompileQueue
+{
+private:
+    struct Job
+    {
+        Shader* shader;
+        unsigned int program;
+        unsigned int vs;
+        unsigned int fs;
+        std::uint64_t cacheKey;
+    };
+
+    std::vector<Job> m_Jobs;
+    bool m_Parallel; // completion status can be queried without waiting
+
+public:
+    ShaderCompileQueue(); // needs a current context
+    ~ShaderCompileQueue();
+
+    ShaderCompileQueue(const ShaderCompileQueue&) = delete;
+    ShaderCompileQueue& operator=(const ShaderCompileQueue&) = delete;
+
+    // hands finished programs to their Shader, returns how many are still pending
+    unsigned int Poll();
+    // blocks until everything submitted is ready
+    void Finish();
+
+    inline unsigned int GetPendingCount() const { return (unsigned int)m_Jobs.size(); }
+    inline bool IsParallel() const { return m_Parallel; }
+
+private:
+    friend class Shader;
+
+    void Submit(Shader& shader, const ShaderProgramSource& source, std::uint64_t cacheKey);
+    void Cancel(Shader& shader);
+    void Complete(Job& job);
+};
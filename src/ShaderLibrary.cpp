@@ -0,0 +1,100 @@
+#include "ShaderLibrary.h"
+#include "ShaderParser.h"
+#include "ShaderWatcher.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    std::string NormalizePath(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().string();
+    }
+}
+
+ShaderLibrary::ShaderLibrary(ShaderCompileQueue* queue, ShaderWatcher* watcher)
+    : m_Queue(queue), m_Watcher(watcher)
+{
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+    if (m_Watcher)
+        for (auto& program : m_Programs)
+            m_Watcher->Unwatch(*program.second);
+}
+
+const std::vector<std::string>& ShaderLibrary::GetVariantKeys(const std::string& filepath)
+{
+    std::string path = NormalizePath(filepath);
+    auto keys = m_VariantKeys.find(path);
+    if (keys != m_VariantKeys.end())
+        return keys->second;
+
+    // the mapping stays cached, so the parse the Shader does right after is cheap
+    std::vector<std::string> parsed;
+    ShaderParser::Parse(path, &parsed);
+    if (parsed.size() > 32)
+    {
+        std::cout << path << " declares more than 32 variant keys, ignoring the rest" << std::endl;
+        parsed.resize(32);
+    }
+    return m_VariantKeys[path] = std::move(parsed);
+}
+
+std::uint32_t ShaderLibrary::GetVariant(const std::string& filepath, std::initializer_list<const char*> defines)
+{
+    const std::vector<std::string>& keys = GetVariantKeys(filepath);
+    std::uint32_t variant = 0;
+    for (const char* define : defines)
+    {
+        bool found = false;
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            if (keys[i] == define)
+            {
+                variant |= 1u << i;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            std::cout << "Unknown variant key " << define << " for " << filepath << std::endl;
+    }
+    return variant;
+}
+
+Shader& ShaderLibrary::Get(const std::string& filepath, std::uint32_t variant)
+{
+    std::string path = NormalizePath(filepath);
+    ProgramKey key{path, variant};
+    auto program = m_Programs.find(key);
+    if (program != m_Programs.end())
+        return *program->second;
+
+    const std::vector<std::string>& keys = GetVariantKeys(path);
+    std::vector<std::string> defines;
+    for (std::size_t i = 0; i < keys.size(); i++)
+        if (variant & (1u << i))
+            defines.push_back(keys[i]);
+
+    auto shader = std::make_unique<Shader>(path, defines, m_Queue);
+    if (m_Watcher)
+        m_Watcher->Watch(*shader);
+    return *(m_Programs[key] = std::move(shader));
+}
+
+Shader& ShaderLibrary::Get(const std::string& filepath, std::initializer_list<const char*> defines)
+{
+    return Get(filepath, GetVariant(filepath, defines));
+}
+
+void ShaderLibrary::Precompile(const std::string& filepath)
+{
+    std::size_t keyCount = GetVariantKeys(filepath).size();
+    if (keyCount > 8)
+        std::cout << "Precompiling " << (1u << keyCount) << " variants of " << filepath << std::endl;
+    for (std::uint64_t variant = 0; variant < (std::uint64_t(1) << keyCount); variant++)
+        Get(filepath, (std::uint32_t)variant);
+}
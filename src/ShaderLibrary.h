@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+class ShaderCompileQueue;
+class ShaderWatcher;
+
+// Keyed program table for .shader files with #variants. A variant is a bitmask
+// over the file's keys (bit i -> the i-th key is true), and every
+// (file, variant) pair is compiled exactly once, on first use or in Precompile.
+class ShaderLibrary
+{
+private:
+    struct ProgramKey
+    {
+        std::string path;
+        std::uint32_t variant;
+
+        bool operator==(const ProgramKey& other) const { return variant == other.variant && path == other.path; }
+    };
+
+    struct ProgramKeyHash
+    {
+        std::size_t operator()(const ProgramKey& key) const
+        {
+            return std::hash<std::string>()(key.path) ^ (std::size_t(key.variant) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    std::unordered_map<ProgramKey, std::unique_ptr<Shader>, ProgramKeyHash> m_Programs;
+    std::unordered_map<std::string, std::vector<std::string>> m_VariantKeys; // per file
+    ShaderCompileQueue* m_Queue;  // optional, new programs are compiled through it
+    ShaderWatcher* m_Watcher;     // optional, new programs are registered with it
+
+public:
+    explicit ShaderLibrary(ShaderCompileQueue* queue = nullptr, ShaderWatcher* watcher = nullptr);
+    ~ShaderLibrary();
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    Shader& Get(const std::string& filepath, std::uint32_t variant = 0);
+    // by key name, unknown keys are reported and ignored
+    Shader& Get(const std::string& filepath, std::initializer_list<const char*> defines);
+
+    // submits every permutation of the file's keys
+    void Precompile(const std::string& filepath);
+
+    const std::vector<std::string>& GetVariantKeys(const std::string& filepath);
+    std::uint32_t GetVariant(const std::string& filepath, std::initializer_list<const char*> defines);
+
+    inline std::size_t GetProgramCount() const { return m_Programs.size(); }
+};
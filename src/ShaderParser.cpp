@@ -0,0 +1,337 @@
+#include "ShaderParser.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// generated by the Makefile from res/shaders, builds without it just read from disk
+#if __has_include("EmbeddedShaders.gen.h")
+#include "EmbeddedShaders.gen.h"
+#define HAS_EMBEDDED_SHADERS 1
+#else
+#define HAS_EMBEDDED_SHADERS 0
+#endif
+
+MappedFile::MappedFile(const std::string& filepath, Access access)
+    : m_Data(nullptr), m_Size(0), m_Open(false), m_Mapped(false)
+{
+    int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat info;
+    if (access == Access::Copy)
+    {
+        // read to the end rather than st_size, the file may change size meanwhile
+        char buffer[16384];
+        ssize_t bytes;
+        while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
+            m_Copy.append(buffer, bytes);
+        if (bytes == 0)
+        {
+            m_Data = m_Copy.data();
+            m_Size = m_Copy.size();
+            m_Open = true;
+        }
+    }
+    else if (fstat(fd, &info) == 0)
+    {
+        m_Open = info.st_size == 0; // nothing to map, but not an error
+        if (info.st_size > 0)
+        {
+            void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_Data = static_cast<const char*>(data);
+                m_Size = info.st_size;
+                m_Open = true;
+                m_Mapped = true;
+            }
+        }
+    }
+    close(fd); // the mapping keeps the file alive
+}
+
+MappedFile::MappedFile(const char* data, std::size_t size)
+    : m_Data(data), m_Size(size), m_Open(true), m_Mapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Mapped)
+        munmap(const_cast<char*>(m_Data), m_Size);
+}
+
+namespace
+{
+    struct CachedFile
+    {
+        std::shared_ptr<const MappedFile> file;
+        std::filesystem::file_time_type writeTime;
+    };
+
+    std::mutex s_CacheMutex;
+    std::unordered_map<std::string, CachedFile> s_FileCache;
+
+    bool DiskOverrideFromEnvironment()
+    {
+        const char* value = std::getenv("MATH_ENGINE_SHADERS_FROM_DISK");
+        return value && *value && std::strcmp(value, "0") != 0;
+    }
+
+    std::atomic<bool> s_DiskOverride(DiskOverrideFromEnvironment());
+
+    enum class ShaderType
+    {
+        NONE = -1,
+        VERTEX = 0,
+        FRAGMENT = 1
+    };
+
+    struct ParseState
+    {
+        ShaderType type = ShaderType::NONE;
+        std::vector<std::string_view> pieces[2];                 // views into the mapped files, in order
+        std::vector<std::shared_ptr<const MappedFile>> files;   // keeps them mapped until the strings are built
+        std::vector<std::string>* variantKeys = nullptr;
+    };
+
+    inline bool StartsWith(std::string_view text, std::string_view prefix)
+    {
+        return text.substr(0, prefix.size()) == prefix;
+    }
+
+    inline std::string_view TrimLeft(std::string_view text)
+    {
+        std::size_t start = text.find_first_not_of(" \t");
+        return start == std::string_view::npos ? std::string_view() : text.substr(start);
+    }
+
+    void AddPiece(std::vector<std::string_view>& pieces, std::string_view line)
+    {
+        // consecutive lines of one file are adjacent in memory, keep them as one view
+        if (!pieces.empty() && pieces.back().data() + pieces.back().size() == line.data())
+            pieces.back() = std::string_view(pieces.back().data(), pieces.back().size() + line.size());
+        else
+            pieces.push_back(line);
+    }
+}
+
+static std::shared_ptr<const MappedFile> OpenEmbedded(const std::string& filepath)
+{
+#if HAS_EMBEDDED_SHADERS
+    // embedded paths are the ones the script was given, e.g. res/shaders/basic.shader
+    if (const EmbeddedShaderFile* file = FindEmbeddedShader(filepath))
+        return std::make_shared<const MappedFile>(file->source.data(), file->source.size());
+#endif
+    return nullptr;
+}
+
+static std::shared_ptr<const MappedFile> OpenFromDisk(const std::string& filepath)
+{
+    std::error_code error;
+    auto writeTime = std::filesystem::last_write_time(filepath, error);
+    if (error)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+    auto cached = s_FileCache.find(filepath);
+    if (cached != s_FileCache.end() && cached->second.writeTime == writeTime)
+        return cached->second.file;
+
+    auto file = std::make_shared<const MappedFile>(filepath, s_DiskOverride ? MappedFile::Access::Copy
+                                                                           : MappedFile::Access::Map);
+    if (!file->IsOpen())
+        return nullptr;
+
+    s_FileCache[filepath] = {file, writeTime};
+    return file;
+}
+
+std::shared_ptr<const MappedFile> ShaderParser::Open(const std::string& filepath)
+{
+    if (s_DiskOverride)
+    {
+        std::shared_ptr<const MappedFile> file = OpenFromDisk(filepath);
+        return file ? file : OpenEmbedded(filepath);
+    }
+
+    std::shared_ptr<const MappedFile> file = OpenEmbedded(filepath);
+    return file ? file : OpenFromDisk(filepath); // anything outside res/shaders
+}
+
+void ShaderParser::SetDiskOverride(bool enabled)
+{
+    // cached files were mapped or copied for the old setting
+    if (s_DiskOverride.exchange(enabled) != enabled)
+        ClearCache();
+}
+
+bool ShaderParser::IsDiskOverride()
+{
+    return s_DiskOverride;
+}
+
+bool ShaderParser::HasEmbeddedSources()
+{
+    return HAS_EMBEDDED_SHADERS;
+}
+
+void ShaderParser::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+    s_FileCache.clear();
+}
+
+static bool ParseFile(const std::string& filepath, ParseState& state, int depth)
+{
+    if (depth > 16)
+    {
+        std::cout << "Shader #include nesting too deep at " << filepath << std::endl;
+        return false;
+    }
+
+    std::string path = std::filesystem::path(filepath).lexically_normal().string();
+    std::shared_ptr<const MappedFile> file = ShaderParser::Open(path);
+    if (!file)
+    {
+        std::cout << "Failed to open shader " << filepath << std::endl;
+        return false;
+    }
+    state.files.push_back(file);
+
+    std::string_view text = file->GetView();
+    while (!text.empty())
+    {
+        std::size_t end = text.find('\n');
+        std::string_view line = end == std::string_view::npos ? text : text.substr(0, end + 1);
+        text.remove_prefix(line.size());
+
+        std::string_view directive = TrimLeft(line);
+        if (StartsWith(directive, "#shader"))
+        {
+            if (directive.find("vertex") != std::string_view::npos)
+                state.type = ShaderType::VERTEX;
+            else if (directive.find("fragment") != std::string_view::npos)
+                state.type = ShaderType::FRAGMENT;
+        }
+        else if (StartsWith(directive, "#include"))
+        {
+            std::size_t open = directive.find('"');
+            std::size_t close = open == std::string_view::npos ? open : directive.find('"', open + 1);
+            if (close == std::string_view::npos)
+            {
+                std::cout << "Malformed #include in " << filepath << std::endl;
+                continue;
+            }
+            std::filesystem::path included = std::filesystem::path(path).parent_path() /
+                                             std::string(directive.substr(open + 1, close - open - 1));
+            if (!ParseFile(included.string(), state, depth + 1))
+                return false;
+        }
+        else if (StartsWith(directive, "#variants"))
+        {
+            std::string_view keys = directive.substr(9);
+            while (true)
+            {
+                std::size_t start = keys.find_first_not_of(" \t\r\n");
+                if (start == std::string_view::npos)
+                    break;
+                keys.remove_prefix(start);
+                std::size_t length = std::min(keys.find_first_of(" \t\r\n"), keys.size());
+                state.variantKeys->push_back(std::string(keys.substr(0, length)));
+                keys.remove_prefix(length);
+            }
+        }
+        else if (state.type != ShaderType::NONE)
+        {
+            AddPiece(state.pieces[(int)state.type], line);
+            if (line.back() != '\n') // last line of a file without a newline
+                AddPiece(state.pieces[(int)state.type], "\n");
+        }
+    }
+    return true;
+}
+
+ShaderProgramSource ShaderParser::Parse(const std::string& filepath, std::vector<std::string>* variantKeys)
+{
+    PROFILE_ZONE("ShaderParser::Parse");
+    ParseState state;
+    state.variantKeys = variantKeys;
+    std::vector<std::string> keys;
+    if (!state.variantKeys)
+        state.variantKeys = &keys;
+    if (!ParseFile(filepath, state, 0))
+        return {};
+
+    std::string stages[2];
+    for (int i = 0; i < 2; i++)
+    {
+        std::size_t size = 0;
+        for (std::string_view piece : state.pieces[i])
+            size += piece.size();
+        stages[i].reserve(size);
+        for (std::string_view piece : state.pieces[i])
+            stages[i].append(piece.data(), piece.size());
+    }
+    return {std::move(stages[0]), std::move(stages[1]), *state.variantKeys};
+}
+
+static std::string InsertDefines(const std::string& stage, const std::string& defines)
+{
+    // #version has to stay the first statement and #extensions come before any declaration
+    std::size_t version = stage.find("#version");
+    if (version == std::string::npos)
+        return defines + stage;
+
+    std::size_t end = stage.find('\n', version);
+    end = end == std::string::npos ? stage.size() : end + 1;
+    while (end < stage.size())
+    {
+        std::size_t next = stage.find('\n', end);
+        next = next == std::string::npos ? stage.size() : next + 1;
+        std::string_view line = TrimLeft(std::string_view(stage).substr(end, next - end));
+        if (!StartsWith(line, "#extension") && !line.empty() && line != "\n" && line != "\r\n")
+            break;
+        end = next;
+    }
+    std::string result;
+    result.reserve(stage.size() + defines.size() + 1);
+    result.append(stage, 0, end);
+    if (end == stage.size() && stage.back() != '\n')
+        result += '\n';
+    result += defines;
+    result.append(stage, end, std::string::npos);
+    return result;
+}
+
+ShaderProgramSource ShaderParser::ApplyDefines(const ShaderProgramSource& source, const std::vector<std::string>& defines)
+{
+    if (defines.empty() && source.VariantKeys.empty())
+        return source;
+
+    // #variants keys are bools in both stages, same as the specialization constants of
+    // the SPIR-V path (tools/compile_spirv.sh), anything else is a plain macro
+    std::string block;
+    for (const std::string& key : source.VariantKeys)
+    {
+        bool enabled = std::find(defines.begin(), defines.end(), key) != defines.end();
+        block += "const bool " + key + (enabled ? " = true;\n" : " = false;\n");
+    }
+    for (const std::string& define : defines)
+        if (std::find(source.VariantKeys.begin(), source.VariantKeys.end(), define) == source.VariantKeys.end())
+            block += "#define " + define + " 1\n";
+    return {InsertDefines(source.VertexSource, block), InsertDefines(source.FragmentSource, block), source.VariantKeys};
+}
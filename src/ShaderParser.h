@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Shader.h"
+
+// read-only view of a whole file through mmap, of a copy of it, or of a source compiled
+// into the binary
+class MappedFile
+{
+private:
+    const char* m_Data;
+    std::size_t m_Size;
+    bool m_Open;
+    bool m_Mapped;       // false for copies and embedded sources, nothing to unmap
+    std::string m_Copy;  // the file's contents when it was read rather than mapped
+
+public:
+    // Copy reads the file into memory instead of mapping it. needed for files that may be
+    // rewritten while the view is in use: an editor truncating a mapped file makes reads
+    // past the new end fault with SIGBUS
+    enum class Access
+    {
+        Map,
+        Copy
+    };
+
+    explicit MappedFile(const std::string& filepath, Access access = Access::Map);
+    // wraps static data (EmbeddedShaders.gen.h), which has to outlive the view
+    MappedFile(const char* data, std::size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool IsOpen() const { return m_Open; }
+    inline std::string_view GetView() const { return std::string_view(m_Data, m_Size); }
+};
+
+// .shader files are mapped, not read, and split into stages as string_views. The
+// only copy is the final per-stage string handed to the driver. Directives:
+//     #shader vertex | fragment    starts a stage
+//     #include "file"              spliced in place, resolved relative to the including file
+//     #variants KEY_A KEY_B        keys the file can be permuted on (ShaderLibrary), each one a
+//                                  const bool in the stages, tested with if (KEY_A) so the
+//                                  same source works as a SPIR-V specialization constant
+// Files are cached by path and reopened when their mtime changes. Thread safe.
+// With the disk override on they are read into memory rather than mapped, the
+// files being edited are exactly the ones hot reload parses.
+//
+// The Makefile embeds res/shaders into the binary (tools/embed_shaders.sh), so by
+// default paths under res/shaders resolve to the compiled-in sources without touching
+// the disk and the executable can run from anywhere. With the disk override on
+// (SetDiskOverride, or MATH_ENGINE_SHADERS_FROM_DISK=1) files on disk win and the
+// embedded copy is only the fallback; hot reload needs that.
+class ShaderParser
+{
+public:
+    // variantKeys, if given, receives the #variants keys in declaration order
+    static ShaderProgramSource Parse(const std::string& filepath, std::vector<std::string>* variantKeys = nullptr);
+
+    // "const bool KEY = true|false;" for the #variants keys and "#define KEY 1" for any other
+    // define, after the #version and #extension lines of each stage
+    static ShaderProgramSource ApplyDefines(const ShaderProgramSource& source, const std::vector<std::string>& defines);
+
+    // the embedded source or the cached view of a file, reopened if it changed on disk.
+    // nullptr if it's neither embedded nor readable
+    static std::shared_ptr<const MappedFile> Open(const std::string& filepath);
+    // drops every cached file
+    static void ClearCache();
+
+    static void SetDiskOverride(bool enabled);
+    static bool IsDiskOverride();
+    // false when the build didn't generate EmbeddedShaders.gen.h
+    static bool HasEmbeddedSources();
+};
@@ -0,0 +1,145 @@
+#include "ShaderWatcher.h"
+#include "ShaderParser.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::string NormalizePath(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().string();
+    }
+
+    bool EndsWith(const std::string& text, const std::string& suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+ShaderWatcher::ShaderWatcher(const std::string& directory)
+    : m_Directory(directory), m_Fd(-1), m_Running(false), m_IncludeChanged(false)
+{
+#ifdef __linux__
+    m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // editors either rewrite the file in place or write a new one and rename it over
+    if (m_Fd >= 0 && inotify_add_watch(m_Fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(m_Fd);
+        m_Fd = -1;
+    }
+#endif
+    if (m_Fd < 0)
+    {
+        std::cout << "Shader hot reload unavailable for " << directory << std::endl;
+        return;
+    }
+
+    m_Running = true;
+    m_Thread = std::thread(&ShaderWatcher::Run, this);
+    std::cout << "Watching " << directory << " for shader changes" << std::endl;
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    m_Running = false;
+    if (m_Thread.joinable())
+        m_Thread.join();
+#ifdef __linux__
+    if (m_Fd >= 0)
+        close(m_Fd);
+#endif
+}
+
+void ShaderWatcher::Watch(Shader& shader)
+{
+    m_Shaders.push_back(&shader);
+}
+
+void ShaderWatcher::Unwatch(Shader& shader)
+{
+    m_Shaders.erase(std::remove(m_Shaders.begin(), m_Shaders.end(), &shader), m_Shaders.end());
+}
+
+void ShaderWatcher::Run()
+{
+#ifdef __linux__
+    Profiler::SetThreadName("shader watcher");
+    alignas(inotify_event) char buffer[4096];
+    while (m_Running)
+    {
+        // short timeout so the destructor never waits long for the thread
+        pollfd fd{m_Fd, POLLIN, 0};
+        if (poll(&fd, 1, 100) <= 0)
+            continue;
+
+        ssize_t length;
+        while ((length = read(m_Fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* ptr = buffer; ptr < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                std::string name = event->len ? event->name : "";
+                if (EndsWith(name, ".glsl"))
+                {
+                    // an #include, any shader may use it
+                    m_IncludeChanged = true;
+                    continue;
+                }
+                if (!EndsWith(name, ".shader"))
+                    continue;
+
+                std::string path = NormalizePath(m_Directory + "/" + name);
+                ShaderProgramSource source = ShaderParser::Parse(path); // off the render thread
+
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Changed[path] = std::move(source);
+            }
+        }
+    }
+#endif
+}
+
+unsigned int ShaderWatcher::Update()
+{
+    bool includeChanged = m_IncludeChanged.exchange(false);
+    std::map<std::string, ShaderProgramSource> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Changed.empty() && !includeChanged)
+            return 0;
+        changed.swap(m_Changed);
+    }
+
+    unsigned int swapped = 0;
+    for (Shader* shader : m_Shaders)
+    {
+        std::string path = NormalizePath(shader->GetFilePath());
+        auto it = changed.find(path);
+        if (it == changed.end() && !includeChanged)
+            continue;
+
+        // an include changed: we can't tell who uses it, re-parse everything here
+        ShaderProgramSource source = it != changed.end() ? it->second : ShaderParser::Parse(path);
+        if (shader->Reload(source))
+        {
+            std::cout << "Reloaded " << shader->GetFilePath() << std::endl;
+            swapped++;
+        }
+        else
+        {
+            std::cout << "Keeping the previous program for " << shader->GetFilePath() << std::endl;
+        }
+    }
+    return swapped;
+}
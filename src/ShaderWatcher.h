@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Shader.h"
+
+// Development hot reload: watches a shader directory with inotify on a
+// background thread, which also re-parses whatever changed. Update(), called
+// between frames on the render thread, recompiles the watched Shaders and swaps
+// the new program in; when compilation fails the old program stays. A changed
+// .glsl include reloads every watched shader.
+// Linux only, elsewhere it never reports a change.
+class ShaderWatcher
+{
+private:
+    std::string m_Directory;
+    std::vector<Shader*> m_Shaders;
+    int m_Fd;
+
+    std::atomic<bool> m_Running;
+    std::atomic<bool> m_IncludeChanged;
+    std::thread m_Thread;
+
+    std::mutex m_Mutex;
+    std::map<std::string, ShaderProgramSource> m_Changed; // normalized path -> parsed source, latest wins
+
+public:
+    explicit ShaderWatcher(const std::string& directory);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    inline bool IsWatching() const { return m_Fd >= 0; }
+
+    void Watch(Shader& shader);
+    void Unwatch(Shader& shader);
+
+    // render thread only, returns how many programs were swapped
+    unsigned int Update();
+
+private:
+    void Run();
+};
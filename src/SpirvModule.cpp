@@ -0,0 +1,90 @@
+#include "SpirvModule.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static bool ReadBinary(const std::string& filepath, std::vector<char>& data)
+{
+    std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+    if (!stream)
+        return false;
+
+    data.resize(stream.tellg());
+    stream.seekg(0);
+    return stream.read(data.data(), data.size()) && !data.empty() && data.size() % 4 == 0;
+}
+
+bool SpirvModule::IsEnabled()
+{
+    static const bool enabled = !GetDirectory().empty() && GLEW_ARB_gl_spirv;
+    return enabled;
+}
+
+const std::string& SpirvModule::GetDirectory()
+{
+    static const std::string directory = [] {
+        const char* value = std::getenv("MATH_ENGINE_SPIRV_DIR");
+        return std::string(value ? value : "");
+    }();
+    return directory;
+}
+
+bool SpirvModule::Load(const std::string& filepath)
+{
+    std::filesystem::path base = std::filesystem::path(GetDirectory()) / std::filesystem::path(filepath).stem();
+
+    std::ifstream manifest(base.string() + ".manifest");
+    if (!manifest
+        || !ReadBinary(base.string() + ".vert.spv", m_VertexBinary)
+        || !ReadBinary(base.string() + ".frag.spv", m_FragmentBinary))
+        return false;
+
+    // "variant KEY id" / "uniform name location" / "block name binding"
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::istringstream fields(line);
+        std::string kind, name;
+        int value;
+        if (!(fields >> kind >> name >> value))
+            continue;
+
+        if (kind == "variant")
+        {
+            if ((int)m_VariantKeys.size() <= value)
+                m_VariantKeys.resize(value + 1);
+            m_VariantKeys[value] = name;
+        }
+        else if (kind == "uniform")
+        {
+            m_UniformLocations[name] = value;
+        }
+        else if (kind == "block")
+        {
+            m_BlockBindings[name] = value;
+        }
+    }
+    return true;
+}
+
+bool SpirvModule::GetSpecialization(const std::vector<std::string>& defines,
+                                    std::vector<unsigned int>& ids, std::vector<unsigned int>& values) const
+{
+    for (const std::string& define : defines)
+        if (std::find(m_VariantKeys.begin(), m_VariantKeys.end(), define) == m_VariantKeys.end())
+            return false;
+
+    // every constant is set explicitly, so a module's defaults never matter
+    for (unsigned int id = 0; id < m_VariantKeys.size(); id++)
+    {
+        bool enabled = std::find(defines.begin(), defines.end(), m_VariantKeys[id]) != defines.end();
+        ids.push_back(id);
+        values.push_back(enabled ? GL_TRUE : GL_FALSE);
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The offline compiled SPIR-V of one .shader file (tools/compile_spirv.sh, `make spirv`),
+// loaded through ARB_gl_spirv so startup skips the GLSL front end. The manifest next to
+// the modules maps #variants keys to specialization constant ids and uniform names to
+// the explicit locations and block bindings the script assigned, since SPIR-V programs
+// have no names to query.
+// Opt-in: only used when $MATH_ENGINE_SPIRV_DIR points at the output directory, anything
+// missing or failing falls back to the GLSL path.
+class SpirvModule
+{
+private:
+    std::vector<char> m_VertexBinary;
+    std::vector<char> m_FragmentBinary;
+    std::vector<std::string> m_VariantKeys; // index = constant_id
+    std::unordered_map<std::string, int> m_UniformLocations;
+    std::unordered_map<std::string, unsigned int> m_BlockBindings; // as compiled in
+
+public:
+    // $MATH_ENGINE_SPIRV_DIR is set and the driver has ARB_gl_spirv
+    static bool IsEnabled();
+    static const std::string& GetDirectory();
+
+    // <dir>/<name>.vert.spv, <name>.frag.spv and <name>.manifest for res/shaders/<name>.shader
+    bool Load(const std::string& filepath);
+
+    // constant ids and values for a permutation, false if a define isn't a #variants key
+    bool GetSpecialization(const std::vector<std::string>& defines,
+                           std::vector<unsigned int>& ids, std::vector<unsigned int>& values) const;
+
+    inline const std::vector<char>& GetVertexBinary() const { return m_VertexBinary; }
+    inline const std::vector<char>& GetFragmentBinary() const { return m_FragmentBinary; }
+    inline const std::unordered_map<std::string, int>& GetUniformLocations() const { return m_UniformLocations; }
+    inline const std::unordered_map<std::string, unsigned int>& GetBlockBindings() const { return m_BlockBindings; }
+};
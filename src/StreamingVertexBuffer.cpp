@@ -0,0 +1,138 @@
+#include "StreamingVertexBuffer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+#include <csignal>
+#include <iostream>
+
+StreamingVertexBuffer::StreamingVertexBuffer(std::size_t size)
+    : m_RendererID(BufferHandle::Create()), m_Mapped(nullptr), m_Size(size), m_Head(0), m_Persistent(GLEW_ARB_buffer_storage)
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+
+    if (m_Persistent)
+    {
+        // coherent, so nothing has to be flushed between writing and drawing
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags));
+        m_Mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+        if (!m_Mapped)
+        {
+            std::cout << "Persistent mapping failed, streaming through glMapBufferRange" << std::endl;
+            m_Persistent = false;
+            // immutable storage can't be respecified, start over with a fresh buffer
+            m_RendererID = BufferHandle::Create();
+            GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+        }
+    }
+    if (!m_Persistent)
+    {
+        GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    for (PendingFence& fence : m_Fences)
+        glDeleteSync(fence.sync);
+
+    if (m_Mapped)
+    {
+        GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
+
+void StreamingVertexBuffer::ReapSignaled()
+{
+    while (!m_Fences.empty())
+    {
+        GLenum status = glClientWaitSync(m_Fences.front().sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+        glDeleteSync(m_Fences.front().sync);
+        m_Fences.pop_front();
+    }
+}
+
+void StreamingVertexBuffer::WaitFor(std::size_t begin, std::size_t end)
+{
+    for (auto it = m_Fences.begin(); it != m_Fences.end(); )
+    {
+        if (it->begin >= end || begin >= it->end)
+        {
+            ++it;
+            continue;
+        }
+
+        // flush once so the fence is guaranteed to be submitted, then block in 1ms steps
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        GLenum status;
+        while ((status = glClientWaitSync(it->sync, flags, 1000000)) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        if (status == GL_WAIT_FAILED)
+            std::cout << "glClientWaitSync failed, streaming over a region that may still be in use" << std::endl;
+
+        glDeleteSync(it->sync);
+        it = m_Fences.erase(it);
+    }
+}
+
+StreamingVertexBuffer::Region StreamingVertexBuffer::Allocate(std::size_t size, std::size_t alignment)
+{
+    std::size_t offset = (m_Head + alignment - 1) / alignment * alignment;
+    if (offset + size > m_Size)
+        offset = 0; // wrap, the tail is left unused this round
+    if (size == 0 || size > m_Size)
+        return { nullptr, 0, 0 };
+
+    ReapSignaled();
+    WaitFor(offset, offset + size);
+    m_Head = offset + size;
+
+    if (m_Persistent)
+        return { m_Mapped + offset, offset, size };
+
+    // the fences already did the synchronizing, the driver doesn't need to
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+    void* data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    return { data, offset, data ? size : 0 };
+}
+
+void StreamingVertexBuffer::Commit(const Region& region)
+{
+    if (m_Persistent || !region.data)
+        return;
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+    GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+}
+
+void StreamingVertexBuffer::Fence(const Region& region)
+{
+    if (region.size == 0)
+        return;
+
+    // a newer fence on the same region covers everything the older one did, so a
+    // region drawn every frame holds one fence, not one per frame
+    ReapSignaled();
+    for (auto it = m_Fences.begin(); it != m_Fences.end(); ++it)
+    {
+        if (it->begin == region.offset && it->end == region.offset + region.size)
+        {
+            glDeleteSync(it->sync);
+            m_Fences.erase(it);
+            break;
+        }
+    }
+    m_Fences.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), region.offset, region.offset + region.size });
+}
+
+void StreamingVertexBuffer::Bind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
+}
+
+void StreamingVertexBuffer::Unbind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+#include <GL/glew.h>
+
+#include "GLHandle.h"
+
+// A vertex buffer for data that changes while the program runs. The storage is
+// allocated once with glBufferStorage and stays mapped, so writes land straight in
+// GPU visible memory: no glBufferData, no reallocation, no implicit sync in the
+// driver. It is handed out as a ring; a GLsync fence placed after the draws that read
+// a region keeps Allocate from wrapping onto it before the GPU is done.
+// Without ARB_buffer_storage every region is mapped unsynchronized instead and
+// unmapped in Commit, with the same fences.
+class StreamingVertexBuffer
+{
+public:
+    struct Region
+    {
+        void* data;         // write here until Commit
+        std::size_t offset; // in bytes from the start of the buffer
+        std::size_t size;
+    };
+
+private:
+    struct PendingFence
+    {
+        GLsync sync;
+        std::size_t begin, end;
+    };
+
+    BufferHandle m_RendererID;
+    unsigned char* m_Mapped; // the whole buffer, persistent mode only
+    std::size_t m_Size;
+    std::size_t m_Head;
+    std::deque<PendingFence> m_Fences; // oldest first
+    bool m_Persistent;
+
+    void WaitFor(std::size_t begin, std::size_t end);
+    void ReapSignaled();
+
+public:
+    explicit StreamingVertexBuffer(std::size_t size);
+    ~StreamingVertexBuffer();
+
+    StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+    StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+
+    // size bytes at an offset that's a multiple of alignment (the vertex stride, so
+    // offset / stride is the first vertex). blocks only if the GPU still reads there.
+    // {nullptr, 0, 0} if size doesn't fit the buffer at all
+    Region Allocate(std::size_t size, std::size_t alignment = 4);
+    // the region is written, it can be drawn from now
+    void Commit(const Region& region);
+    // call after the last draws that read the region were issued, at the latest before
+    // the region is replaced. fencing a region again replaces its previous fence
+    void Fence(const Region& region);
+
+    void Bind() const;
+    void Unbind() const;
+
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
+    inline std::size_t GetSize() const { return m_Size; }
+    inline bool IsPersistent() const { return m_Persistent; }
+};
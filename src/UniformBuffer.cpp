@@ -0,0 +1,67 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+static std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UniformRingBuffer::UniformRingBuffer(std::size_t frameSize, unsigned int frameCount)
+    : m_RendererID(BufferHandle::Create()), m_FrameCount(frameCount), m_Frame(0), m_Alignment(256), m_Overflowed(false)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0)
+        m_Alignment = alignment;
+
+    m_FrameSize = AlignUp(frameSize, m_Alignment);
+    m_Staging.reserve(m_FrameSize);
+
+    GLCall(GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID.Get()));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, m_FrameSize * m_FrameCount, nullptr, GL_DYNAMIC_DRAW));
+}
+
+void UniformRingBuffer::BeginFrame()
+{
+    m_Frame = (m_Frame + 1) % m_FrameCount;
+    m_Staging.clear();
+}
+
+UniformAllocation UniformRingBuffer::Push(const void* data, std::size_t size)
+{
+    std::size_t offset = AlignUp(m_Staging.size(), m_Alignment);
+    if (offset + size > m_FrameSize)
+    {
+        if (!m_Overflowed) // once, not every frame
+            std::cout << "Uniform ring buffer is full (" << m_FrameSize << " bytes per frame), dropping blocks" << std::endl;
+        m_Overflowed = true;
+        return { 0, 0 };
+    }
+
+    m_Staging.resize(offset + size);
+    std::memcpy(m_Staging.data() + offset, data, size);
+    return { m_Frame * m_FrameSize + offset, size };
+}
+
+void UniformRingBuffer::Upload()
+{
+    PROFILE_ZONE("UniformRingBuffer::Upload");
+    if (m_Staging.empty())
+        return;
+
+    GLCall(GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID.Get()));
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, m_Frame * m_FrameSize, m_Staging.size(), m_Staging.data()));
+}
+
+void UniformRingBuffer::Bind(unsigned int binding, const UniformAllocation& allocation) const
+{
+    if (allocation.size == 0)
+        return;
+    GLCall(GLStateCache::Get().BindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID.Get(), allocation.offset, allocation.size));
+}
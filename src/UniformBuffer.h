@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "GLHandle.h"
+
+// C++ mirrors of the std140 types, aligned the way std140 aligns them so a block
+// struct built from these has the GLSL offsets. There is no vec3: std140 packs a
+// following scalar into its last 4 bytes, which C++ can't express, use vec4.
+namespace std140
+{
+    struct alignas(8) vec2 { float x, y; };
+    struct alignas(16) vec4 { float x, y, z, w; };
+    struct alignas(16) ivec4 { int x, y, z, w; };
+    struct alignas(16) mat3 { vec4 columns[3]; }; // every column padded to a vec4
+    struct alignas(16) mat4 { vec4 columns[4]; };
+
+    constexpr mat4 identity = { { {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1} } };
+
+    // what every block struct has to be for a plain memcpy into the buffer
+    template <typename T>
+    constexpr bool IsBlock = std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>
+                             && sizeof(T) % 16 == 0 && alignof(T) <= 16;
+}
+
+// next to a block struct, once per member: fails to compile if the C++ offset drifts from the GLSL one
+#define STD140_OFFSET(Block, member, offset) \
+    static_assert(offsetof(Block, member) == (offset), #Block "::" #member " is not at its std140 offset")
+
+struct UniformAllocation
+{
+    std::size_t offset; // into the ring buffer
+    std::size_t size;   // 0 if the frame ran out of space
+};
+
+// One GL_UNIFORM_BUFFER split into a segment per frame in flight. Blocks pushed
+// during a frame are staged on the CPU and go up in a single glBufferSubData,
+// each draw then binds its slice with glBindBufferRange. There are no fences:
+// glBufferSubData is what keeps an upload from landing under draws that still
+// read the old data, the driver syncs it implicitly. Rotating segments only
+// makes that sync unlikely to stall, so don't switch to unsynchronized mapping
+// without adding fences.
+class UniformRingBuffer
+{
+private:
+    BufferHandle m_RendererID;
+    std::size_t m_FrameSize;  // bytes per segment, a multiple of the offset alignment
+    unsigned int m_FrameCount;
+    unsigned int m_Frame;     // segment being written
+    std::size_t m_Alignment;  // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    std::vector<unsigned char> m_Staging;
+    bool m_Overflowed;
+public:
+    explicit UniformRingBuffer(std::size_t frameSize, unsigned int frameCount = 3);
+
+    // moves on to the next segment and drops last frame's blocks
+    void BeginFrame();
+
+    template <typename T>
+    UniformAllocation Push(const T& block)
+    {
+        static_assert(std140::IsBlock<T>, "uniform blocks need std140 types and a size that's a multiple of 16");
+        return Push(&block, sizeof(T));
+    }
+    UniformAllocation Push(const void* data, std::size_t size);
+
+    // everything pushed this frame, in one call
+    void Upload();
+
+    void Bind(unsigned int binding, const UniformAllocation& allocation) const;
+
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
+    inline std::size_t GetFrameUsage() const { return m_Staging.size(); } // bytes
+};
@@ -1,66 +1,83 @@
 #include "VertexArray.h"
 #include "Renderer.h"
-#include "VertexBufferLayout.h"
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "StreamingVertexBuffer.h"
+#include "BufferPool.h"
 
-void VertexBufferLayout::Push(unsigned int type, unsigned int count)
+#include <csignal>
+
+VertexArray::VertexArray()
+    : m_RendererID(VertexArrayHandle::Create()), m_Stride(0), m_ApplyPointers(nullptr)
 {
-    std::cout << "Pushing element: type=" << type << ", count=" << count << std::endl;
+    // a name from glGenVertexArrays only becomes a vertex array once it is bound
+    if (!HasDirectStateAccess())
+        GLStateCache::Get().BindVertexArray(m_RendererID.Get());
+}
 
-    m_Elements.push_back(VertexBufferElement{type, count, static_cast<unsigned char>(type == GL_UNSIGNED_BYTE ? GL_TRUE : GL_FALSE)});
-    m_Stride += count * VertexBufferElement::GetSizeOfType(type);
+void VertexArray::SetFormat(unsigned int stride, void (*applyPointers)(std::uintptr_t), void (*applyFormat)(unsigned int))
+{
+    m_Stride = stride;
+    m_ApplyPointers = applyPointers;
+    // without DSA the pointers include the buffer, they are applied with it
+    if (HasDirectStateAccess())
+        applyFormat(m_RendererID.Get());
+}
 
-    // Debugging output
-    for (const auto &element : m_Elements)
+void VertexArray::SetVertexBuffer(unsigned int buffer, std::size_t offset)
+{
+    if (HasDirectStateAccess())
     {
-        std::cout << "Stored Element: type=" << element.type
-                  << ", count=" << element.count
-                  << ", normalized=" << element.normalized
-                  << std::endl;
+        GLCall(glVertexArrayVertexBuffer(m_RendererID.Get(), 0, buffer, offset, m_Stride));
+        return;
     }
+
+    Bind();
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (m_ApplyPointers)
+        m_ApplyPointers(offset);
 }
 
-VertexArray::VertexArray()
+void VertexArray::SetIndexBuffer(unsigned int buffer)
 {
-    glGenVertexArrays(1, &m_RendererID);
-    glBindVertexArray(m_RendererID);
+    if (HasDirectStateAccess())
+    {
+        GLCall(glVertexArrayElementBuffer(m_RendererID.Get(), buffer));
+        GLStateCache::Get().OnVertexArrayElementBuffer(m_RendererID.Get(), buffer);
+        return;
+    }
+
+    Bind();
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
 }
 
-VertexArray::~VertexArray()
+void VertexArray::SetVertexBuffer(const VertexBuffer &vb, std::size_t offset)
 {
-    glDeleteVertexArrays(1, &m_RendererID);
+    SetVertexBuffer(vb.GetRendererID(), offset);
 }
 
-void VertexArray::AddBuffer(const VertexBuffer &vb, const VertexBufferLayout &layout)
+void VertexArray::SetVertexBuffer(const StreamingVertexBuffer &vb, std::size_t offset)
 {
-    Bind();
-    vb.Bind();
-    const auto &elements = layout.GetElements();
-    unsigned int offset = 0;
+    SetVertexBuffer(vb.GetRendererID(), offset);
+}
 
-    for (unsigned int i = 0; i < elements.size(); i++)
-    {
-        const auto &element = elements[i];
-        std::cout << "Adding attribute " << i
-                  << ": count=" << element.count
-                  << ", type=" << element.type
-                  << ", normalized=" << element.normalized
-                  << ", stride=" << layout.GetStride()
-                  << ", offset=" << offset
-                  << std::endl;
+void VertexArray::SetIndexBuffer(const IndexBuffer &ib)
+{
+    SetIndexBuffer(ib.GetRendererID());
+}
 
-        glEnableVertexAttribArray(i); // Enable the correct attribute index
-        glVertexAttribPointer(i, element.count, element.type, element.normalized,
-                              layout.GetStride(), reinterpret_cast<const void *>(offset));
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
-    }
+void VertexArray::SetPage(const BufferPool &pool, unsigned int page)
+{
+    SetVertexBuffer(pool.GetBuffer(page), 0);
+    SetIndexBuffer(pool.GetBuffer(page));
 }
 
 void VertexArray::Bind() const
 {
-    glBindVertexArray(m_RendererID);
+    GLStateCache::Get().BindVertexArray(m_RendererID.Get());
 }
 
 void VertexArray::Unbind() const
 {
-    glBindVertexArray(0);
+    GLStateCache::Get().BindVertexArray(0);
 }
@@ -1,18 +1,80 @@
 #pragma once
 
+#include <cstddef>
+
+#include "GLHandle.h"
 #include "VertexBuffer.h"
-#include "VertexBufferLayout.h"
+#include "VertexLayout.h"
+
+class IndexBuffer;
+class StreamingVertexBuffer;
+class BufferPool;
 
-class VertexArray
+// The vertex format is set once and kept apart from the buffer it reads, so one
+// vertex array can be pointed at any number of buffers of that format. With direct
+// state access (HasDirectStateAccess) format and buffers are set by name and nothing
+// that is bound changes; otherwise this vertex array gets bound and the attribute
+// pointers are re-applied for every new buffer.
+class VertexArray // move only, like the buffers
 {
 private:
-    unsigned int m_RendererID;
+    VertexArrayHandle m_RendererID;
+    unsigned int m_Stride;                       // of the format, 0 until SetFormat
+    void (*m_ApplyPointers)(std::uintptr_t base); // the format for the bind-to-edit path
+
+    void SetFormat(unsigned int stride, void (*applyPointers)(std::uintptr_t), void (*applyFormat)(unsigned int));
+    void SetVertexBuffer(unsigned int buffer, std::size_t offset);
+    void SetIndexBuffer(unsigned int buffer);
+    void SetPage(const BufferPool &pool, unsigned int page);
+
+    template <typename Vertex>
+    void SetVertexFormat()
+    {
+        using Layout = typename Vertex::Layout;
+        static_assert(Layout::Stride == sizeof(Vertex), "the vertex layout's stride is not the size of the vertex");
+        static_assert(Layout::template Matches<Vertex>, "the vertex has to be a plain struct of its attributes");
+        SetFormat(Layout::Stride, &Layout::Apply, &Layout::ApplyFormat);
+    }
 
 public:
     VertexArray();
-    ~VertexArray();
 
-    void AddBuffer(const VertexBuffer &vb, const VertexBufferLayout &layout);
+    // Layout is a VertexLayout<...>, its attribute setup is compiled in
+    template <typename Layout>
+    void SetFormat()
+    {
+        SetFormat(Layout::Stride, &Layout::Apply, &Layout::ApplyFormat);
+    }
+
+    // the vertices to read from now on, offset in bytes. the format stays, set it first
+    void SetVertexBuffer(const VertexBuffer &vb, std::size_t offset = 0);
+    void SetVertexBuffer(const StreamingVertexBuffer &vb, std::size_t offset = 0);
+    void SetIndexBuffer(const IndexBuffer &ib);
+
+    // SetFormat and SetVertexBuffer in one go, for a buffer of Vertex structs. the
+    // format is Vertex::Layout, and it has to describe exactly one Vertex
+    template <typename Vertex>
+    void AddBuffer(const VertexBuffer &vb)
+    {
+        SetVertexFormat<Vertex>();
+        SetVertexBuffer(vb);
+    }
+    template <typename Vertex>
+    void AddBuffer(const StreamingVertexBuffer &vb)
+    {
+        SetVertexFormat<Vertex>();
+        SetVertexBuffer(vb);
+    }
+    // one page of the pool as vertex and element buffer, for meshes sub-allocated from it
+    template <typename Vertex>
+    void AddBuffer(const BufferPool &pool, unsigned int page)
+    {
+        SetVertexFormat<Vertex>();
+        SetPage(pool, page);
+    }
+
     void Bind() const;
     void Unbind() const;
-};
\ No newline at end of file
+
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
+};
@@ -1,25 +1,52 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+#include <csignal>
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+    : m_RendererID(BufferHandle::Create()) // deleted along with the handle, no destructor needed
 {
-    glGenBuffers(1, &m_RendererID); // an id for the object, hence the pointer
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    PROFILE_ZONE("VertexBuffer upload");
+    if (HasDirectStateAccess())
+    {
+        // immutable, written afterwards only through Map. nothing gets bound
+        GLCall(glNamedBufferStorage(m_RendererID.Get(), size, data, GL_MAP_WRITE_BIT));
+        return;
+    }
+
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
     //the line below links the buffer with the vao
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW); // this size is in bytes
 }
 
-VertexBuffer::~VertexBuffer()
+void VertexBuffer::Bind() const
 {
-    glDeleteBuffers(1, &m_RendererID);
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID.Get());
 }
 
-void VertexBuffer::Bind() const
+void VertexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void VertexBuffer::Unbind() const
+void* VertexBuffer::Map(std::size_t size) const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
\ No newline at end of file
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    if (HasDirectStateAccess())
+        return glMapNamedBufferRange(m_RendererID.Get(), 0, size, access);
+    Bind();
+    return glMapBufferRange(GL_ARRAY_BUFFER, 0, size, access);
+}
+
+void VertexBuffer::Unmap() const
+{
+    if (HasDirectStateAccess())
+    {
+        glUnmapNamedBuffer(m_RendererID.Get());
+        return;
+    }
+    Bind();
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+}
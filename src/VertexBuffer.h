@@ -1,13 +1,22 @@
 #pragma once
 
-class VertexBuffer
+#include <cstddef>
+
+#include "GLHandle.h"
+
+class VertexBuffer // move only, the GL buffer goes with it
 {
 private:
-    unsigned int m_RendererID;
+    BufferHandle m_RendererID;
 public:
     VertexBuffer(const void* data, unsigned int size);
-    ~VertexBuffer(); // Destructor
 
     void Bind() const;
     void Unbind() const;
-};
\ No newline at end of file
+
+    // the first size bytes for writing, previous contents discarded. nullptr on failure
+    void* Map(std::size_t size) const;
+    void Unmap() const;
+
+    inline unsigned int GetRendererID() const { return m_RendererID.Get(); }
+};
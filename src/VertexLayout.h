@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <GL/glew.h>
+
+// One vertex attribute: what glVertexAttribPointer needs, known at compile time.
+// Integer attributes go through glVertexAttribIPointer and reach the shader as int/uint.
+template <unsigned int GLType, unsigned int ComponentCount, bool IsNormalized, bool IsInteger, typename Component>
+struct VertexAttribute
+{
+    static constexpr unsigned int Type = GLType;
+    static constexpr unsigned int Count = ComponentCount;
+    static constexpr bool Normalized = IsNormalized;
+    static constexpr bool Integer = IsInteger;
+    static constexpr unsigned int Size = ComponentCount * sizeof(Component);
+};
+
+using Float1 = VertexAttribute<GL_FLOAT, 1, false, false, float>;
+using Float2 = VertexAttribute<GL_FLOAT, 2, false, false, float>;
+using Float3 = VertexAttribute<GL_FLOAT, 3, false, false, float>;
+using Float4 = VertexAttribute<GL_FLOAT, 4, false, false, float>;
+using UByte4Norm = VertexAttribute<GL_UNSIGNED_BYTE, 4, true, false, std::uint8_t>; // colors, 0..255 -> 0..1
+using UInt1 = VertexAttribute<GL_UNSIGNED_INT, 1, false, true, std::uint32_t>;
+
+// The attributes of one interleaved vertex, in location order, e.g.
+//     using ColoredVertex = VertexLayout<Float2, UByte4Norm>;
+// Stride and offsets are constants and Apply() is one glEnableVertexAttribArray +
+// glVertexAttrib*Pointer pair per attribute, unrolled: no heap, no loop over a
+// description, nothing printed. ApplyFormat() is the same for direct state access,
+// format only, every attribute reads from buffer binding 0. Pass it to
+// VertexArray::SetFormat<Layout>, or name it Layout in the vertex struct for
+// AddBuffer<Vertex>.
+template <typename... Attributes>
+struct VertexLayout
+{
+    static_assert(sizeof...(Attributes) > 0, "a vertex layout needs at least one attribute");
+
+    static constexpr unsigned int Count = sizeof...(Attributes);
+    static constexpr unsigned int Stride = (Attributes::Size + ...);
+
+    template <unsigned int Index>
+    using Attribute = std::tuple_element_t<Index, std::tuple<Attributes...>>;
+
+private:
+    static constexpr std::array<unsigned int, Count> MakeOffsets()
+    {
+        constexpr unsigned int sizes[] = { Attributes::Size... };
+        std::array<unsigned int, Count> offsets = {};
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offsets;
+    }
+
+public:
+    // byte offset of each attribute within the vertex
+    static constexpr std::array<unsigned int, Count> Offsets = MakeOffsets();
+
+    // the vertex array and the buffer have to be bound, the vertices start at base bytes
+    static void Apply(std::uintptr_t base = 0) { Apply(base, std::make_index_sequence<Count>()); }
+    // GL 4.5, nothing has to be bound
+    static void ApplyFormat(unsigned int vertexArray) { ApplyFormat(vertexArray, std::make_index_sequence<Count>()); }
+
+    // a vertex struct that is exactly this layout's size. use VERTEX_ATTRIBUTE for the members
+    template <typename Vertex>
+    static constexpr bool Matches = sizeof(Vertex) == Stride && std::is_standard_layout_v<Vertex>
+                                    && std::is_trivially_copyable_v<Vertex>;
+
+private:
+    template <std::size_t... Index>
+    static void Apply(std::uintptr_t base, std::index_sequence<Index...>)
+    {
+        (SetAttribute<Attributes>(Index, base), ...);
+    }
+
+    template <std::size_t... Index>
+    static void ApplyFormat(unsigned int vertexArray, std::index_sequence<Index...>)
+    {
+        (SetAttributeFormat<Attributes>(vertexArray, Index), ...);
+    }
+
+    template <typename A>
+    static void SetAttribute(unsigned int index, std::uintptr_t base)
+    {
+        const void* offset = reinterpret_cast<const void*>(base + Offsets[index]);
+        glEnableVertexAttribArray(index);
+        if constexpr (A::Integer)
+            glVertexAttribIPointer(index, A::Count, A::Type, Stride, offset);
+        else
+            glVertexAttribPointer(index, A::Count, A::Type, A::Normalized ? GL_TRUE : GL_FALSE, Stride, offset);
+    }
+
+    template <typename A>
+    static void SetAttributeFormat(unsigned int vertexArray, unsigned int index)
+    {
+        glEnableVertexArrayAttrib(vertexArray, index);
+        if constexpr (A::Integer)
+            glVertexArrayAttribIFormat(vertexArray, index, A::Count, A::Type, Offsets[index]);
+        else
+            glVertexArrayAttribFormat(vertexArray, index, A::Count, A::Type, A::Normalized ? GL_TRUE : GL_FALSE, Offsets[index]);
+        glVertexArrayAttribBinding(vertexArray, index, 0);
+    }
+};
+
+// next to a vertex struct: fails to compile if it doesn't match the layout
+#define VERTEX_LAYOUT(Vertex, Layout) \
+    static_assert(Layout::template Matches<Vertex>, #Vertex " is not the size of its vertex layout")
+// once per member: at the offset and of the size of attribute index
+#define VERTEX_ATTRIBUTE(Vertex, member, Layout, index)                                               \
+    static_assert(offsetof(Vertex, member) == Layout::Offsets[index]                                 \
+                  && sizeof(Vertex::member) == Layout::template Attribute<index>::Size,              \
+                  #Vertex "::" #member " does not match attribute " #index " of its vertex layout")
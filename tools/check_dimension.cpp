@@ -0,0 +1,58 @@
+// Checks the generators against the theoretical box-counting dimension of their
+// fractals, `make check-dimension`. Exits non zero if any is off by more than its
+// tolerance, so a generator change that breaks the geometry fails the build.
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "BoxCounting.h"
+#include "Fractals.h"
+
+struct DimensionCheck
+{
+    const char* name;
+    std::vector<float> vertices;
+    FractalPrimitive primitive;
+    double expected;
+};
+
+int main()
+{
+    // deep enough that the smallest pieces are below the finest grid's boxes,
+    // otherwise the filled triangles count as 2D at the fine levels. the coarse
+    // levels are left out of the fit, box counting only converges from above there
+    const int sierpinskiDepth = 12;
+    const int kochDepth = 9;
+    BoxCountingParams params;
+    params.minLevel = 8;
+    params.maxLevel = 12;
+    const double tolerance = 0.02;
+
+    const float p0[2] = { -0.5f, -0.5f };
+    const float p1[2] = { 0.5f, -0.5f };
+    const float p2[2] = { 0.0f, 0.5f };
+
+    std::vector<DimensionCheck> checks;
+
+    checks.push_back({ "Sierpinski triangle", {}, FractalPrimitive::Triangles, std::log(3.0) / std::log(2.0) });
+    generateSierpinski(checks.back().vertices, p0, p1, p2, sierpinskiDepth);
+
+    // the snowflake's dimension is the Koch curve's, all three edges
+    checks.push_back({ "Koch snowflake", {}, FractalPrimitive::Lines, std::log(4.0) / std::log(3.0) });
+    generateKochSnowflake(checks.back().vertices, p0, p1, kochDepth);
+    generateKochSnowflake(checks.back().vertices, p1, p2, kochDepth);
+    generateKochSnowflake(checks.back().vertices, p2, p0, kochDepth);
+
+    int failures = 0;
+    for (const DimensionCheck& check : checks)
+    {
+        BoxCountingResult result = EstimateBoxDimension(check.vertices, check.primitive, params);
+        double error = std::abs(result.dimension - check.expected);
+        bool ok = error <= tolerance;
+        std::cout << (ok ? "ok   " : "FAIL ") << check.name << ": " << result.dimension << ", expected "
+                  << check.expected << " +- " << tolerance << " (fit error " << result.fitError << ")" << std::endl;
+        if (!ok)
+            failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#!/bin/sh
+# Compiles .shader files to SPIR-V for ARB_gl_spirv (see SpirvModule.h), which also
+# validates every shader at build time.
+#     sh tools/compile_spirv.sh spirv res/shaders/*.shader
+# writes, per file, <out>/<name>.vert.spv, <out>/<name>.frag.spv and <out>/<name>.manifest.
+#
+# SPIR-V programs can't be queried by name, so every default block uniform gets an
+# explicit location here (shared between the stages, arrays take one per element) and
+# the manifest records them for Shader::GetUniformLocation. Uniform blocks declared as
+# `layout(...) uniform Name` get an explicit binding the same way, in order of first
+# appearance, so Shader::SetUniformBlockBinding can find them without names.
+# #variants keys become specialization constants, constant_id = position of the key
+# in the #variants line.
+set -e
+
+GLSLANG=${GLSLANG:-glslangValidator}
+out=$1
+shift
+mkdir -p "$out"
+
+for file in "$@"; do
+    name=$(basename "$file" .shader)
+    work="$out/$name"
+
+    awk -v vert="$work.vert" -v frag="$work.frag" -v manifest="$work.manifest" '
+    function dirname(path) {
+        return path ~ /\// ? substr(path, 1, match(path, /\/[^\/]*$/) - 1) : "."
+    }
+
+    function emit(line,    declaration, uniform, count, i) {
+        if (stage == "")
+            return
+        target = stage == "vertex" ? vert : frag
+
+        if (line ~ /^[ \t]*#version/) {
+            print line > target
+            # after #version, before anything else, as the extensions have to be
+            print "#extension GL_ARB_explicit_uniform_location : require" > target
+            print "#extension GL_ARB_separate_shader_objects : require" > target
+            print "#extension GL_ARB_shading_language_420pack : require" > target
+            constantsPending = 1
+            return
+        }
+
+        # the constants are declarations, they go after the #extension lines of the stage
+        if (constantsPending && line !~ /^[ \t]*(#extension|\/\/)/ && line !~ /^[ \t\r]*$/) {
+            for (i = 0; i < variantCount; i++)
+                print "layout(constant_id = " i ") const bool " variants[i] " = false;" > target
+            constantsPending = 0
+        }
+
+        if (line ~ /^[ \t]*uniform[ \t]+[A-Za-z0-9_]+[ \t]+[A-Za-z_][A-Za-z0-9_]*[ \t]*(\[[0-9]+\])?[ \t]*;/) {
+            declaration = line
+            sub(/^[ \t]*uniform[ \t]+[A-Za-z0-9_]+[ \t]+/, "", declaration)
+            uniform = declaration
+            sub(/[ \t]*[\[;].*$/, "", uniform)
+            count = 1
+            if (declaration ~ /\[[0-9]+\]/) {
+                count = declaration
+                sub(/^[^\[]*\[/, "", count)
+                sub(/\].*$/, "", count)
+                count += 0
+            }
+            if (!(uniform in locations)) {
+                locations[uniform] = nextLocation + 0
+                nextLocation += count
+                print "uniform " uniform " " locations[uniform] > manifest
+            }
+            print "layout(location = " locations[uniform] ") " line > target
+            return
+        }
+
+        if (line ~ /^[ \t]*layout[ \t]*\([^)]*\)[ \t]*uniform[ \t]+[A-Za-z_][A-Za-z0-9_]*[ \t\r]*$/ && line !~ /binding/) {
+            block = line
+            sub(/^.*uniform[ \t]+/, "", block)
+            sub(/[ \t\r]*$/, "", block)
+            if (!(block in bindings)) {
+                bindings[block] = nextBinding + 0
+                nextBinding++
+                print "block " block " " bindings[block] > manifest
+            }
+            sub(/\)[ \t]*uniform/, ", binding = " bindings[block] ") uniform", line)
+            print line > target
+            return
+        }
+
+        print line > target
+    }
+
+    function parse(path, depth,    line, directive, included, key, keys, n) {
+        if (depth > 16) {
+            print "compile_spirv.sh: #include nesting too deep at " path > "/dev/stderr"
+            exit 1
+        }
+        while ((getline line < path) > 0) {
+            directive = line
+            sub(/^[ \t]+/, "", directive)
+            if (directive ~ /^#shader/) {
+                stage = directive ~ /vertex/ ? "vertex" : directive ~ /fragment/ ? "fragment" : stage
+            } else if (directive ~ /^#include/) {
+                included = directive
+                sub(/^[^"]*"/, "", included)
+                sub(/".*$/, "", included)
+                parse(dirname(path) "/" included, depth + 1)
+            } else if (directive ~ /^#variants/) {
+                # has to come before the first #shader, the constants go at the top of each stage
+                n = split(substr(directive, 10), keys, /[ \t\r]+/)
+                for (key = 1; key <= n; key++) {
+                    if (keys[key] == "")
+                        continue
+                    print "variant " keys[key] " " variantCount + 0 > manifest
+                    variants[variantCount++] = keys[key]
+                }
+            } else {
+                emit(line)
+            }
+        }
+        close(path)
+    }
+
+    BEGIN {
+        printf "" > manifest
+        printf "" > vert
+        printf "" > frag
+        parse(ARGV[1], 0)
+        exit 0
+    }' "$file"
+
+    # --aml for the stage interface left without explicit locations, --amb for blocks
+    # the script didn't recognise
+    "$GLSLANG" -G --aml --amb -S vert -o "$work.vert.spv" "$work.vert"
+    "$GLSLANG" -G --aml --amb -S frag -o "$work.frag.spv" "$work.frag"
+    rm -f "$work.vert" "$work.frag"
+done
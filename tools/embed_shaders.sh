@@ -0,0 +1,48 @@
+#!/bin/sh
+# Turns the given shader files into a header of constexpr string tables, so the
+# binary doesn't need res/shaders at runtime (see ShaderParser::Open).
+#     sh tools/embed_shaders.sh res/shaders/*.shader > src/EmbeddedShaders.gen.h
+set -e
+
+echo "// generated by tools/embed_shaders.sh, do not edit"
+echo "#pragma once"
+echo
+echo "#include <cstddef>"
+echo "#include <string_view>"
+echo
+echo "struct EmbeddedShaderFile"
+echo "{"
+echo "    std::string_view path; // as given to the script, e.g. res/shaders/basic.shader"
+echo "    std::string_view source;"
+echo "};"
+echo
+echo "inline constexpr EmbeddedShaderFile kEmbeddedShaders[] = {"
+for file in "$@"; do
+    if grep -q ')__shader__"' "$file"; then
+        echo "embed_shaders.sh: $file contains the raw string delimiter" >&2
+        exit 1
+    fi
+    printf '    { "%s", R"__shader__(' "$file"
+    cat "$file"
+    printf ')__shader__" },\n'
+done
+echo "};"
+echo
+echo "// indices into kEmbeddedShaders, named after the path below res/shaders"
+echo "namespace EmbeddedShader"
+echo "{"
+index=0
+for file in "$@"; do
+    name=$(echo "${file#res/shaders/}" | sed 's/[^A-Za-z0-9]/_/g')
+    echo "    constexpr std::size_t $name = $index;"
+    index=$((index + 1))
+done
+echo "}"
+echo
+echo "constexpr const EmbeddedShaderFile* FindEmbeddedShader(std::string_view path)"
+echo "{"
+echo "    for (const EmbeddedShaderFile& file : kEmbeddedShaders)"
+echo "        if (file.path == path)"
+echo "            return &file;"
+echo "    return nullptr;"
+echo "}"
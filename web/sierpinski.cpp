@@ -16,6 +16,15 @@ struct Point {
 
 std::vector<Point> vertices;
 int depth = 3;
+const int maxDepth = 8; // the slider's upper end, the buffer is sized for it once
+
+// 3^depth triangles
+size_t PointCount(int depth) {
+    size_t count = 3;
+    for (int i = 0; i < depth; ++i)
+        count *= 3;
+    return count;
+}
 
 // Shader sources
 const char* vertexShaderSource = R"(
@@ -97,10 +106,12 @@ void MainLoop() {
 
     // ImGui UI
     ImGui::Begin("Controls");
-    if (ImGui::SliderInt("Depth", &depth, 0, 8)) {
+    if (ImGui::SliderInt("Depth", &depth, 0, maxDepth)) {
+        // WebGL has no glBufferStorage or persistent mapping (StreamingVertexBuffer on
+        // desktop), but the storage never has to be reallocated: overwrite the front of it
         GenerateSierpinski(depth);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Point), vertices.data(), GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Point), vertices.data());
     }
     ImGui::End();
 
@@ -167,7 +178,8 @@ int main() {
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Point), vertices.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, PointCount(maxDepth) * sizeof(Point), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Point), vertices.data());
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)0);
     glEnableVertexAttribArray(0);
 